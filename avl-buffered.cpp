@@ -0,0 +1,138 @@
+/*!*****************************************************************************
+*\file     avl-buffered.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	AVLmap with a write-combining front buffer for insert heavy ingest.
+
+	flush() stable sorts the buffer by key, so the last write to a key is
+	the last of its run, and applies one write per key in ascending order.
+	Each write starts from the previous one through the finger API
+	(insert(hint, ...) / find_near), which only climbs as far as the gap
+	between neighbouring keys requires.
+******************************************************************************/
+
+#include "avl-buffered.h"
+#include <algorithm> // std::stable_sort
+
+/*!****************************************************************************
+// Class BufferedAVLmap Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// CTOR
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+CS280::BufferedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE>::BufferedAVLmap(std::size_t bufferEntries)
+	: bufferEntries((bufferEntries) ? bufferEntries : 1) {
+	buffer.reserve(this->bufferEntries);
+}
+
+//-----------------------------------------------------------------------------
+// Insert
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+void CS280::BufferedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE>::insert(KEY_TYPE const& key, VALUE_TYPE const& value) {
+	if (buffer.size() == bufferEntries) flush();
+	buffer.push_back(Write{ key, value, false });
+}
+
+//-----------------------------------------------------------------------------
+// Erase - a tombstone that hides the key until the flush removes it
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+void CS280::BufferedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE>::erase(KEY_TYPE const& key) {
+	if (buffer.size() == bufferEntries) flush();
+	buffer.push_back(Write{ key, VALUE_TYPE(), true });
+}
+
+//-----------------------------------------------------------------------------
+// Find
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+VALUE_TYPE const* CS280::BufferedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE>::find(KEY_TYPE const& key) {
+	for (std::size_t i = buffer.size(); i > 0; --i) {
+		Write const& w = buffer[i - 1];
+		if (!(w.key < key) && !(key < w.key)) {
+			return (w.erase) ? nullptr : &w.value;
+		}
+	}
+
+	typename map_type::iterator it = entries.find(key);
+	return (it == entries.end()) ? nullptr : &it->Value();
+}
+
+//-----------------------------------------------------------------------------
+// Contains
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+bool CS280::BufferedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE>::contains(KEY_TYPE const& key) {
+	return find(key) != nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Flush - one sorted, hinted pass over the tree
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+void CS280::BufferedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE>::flush() {
+	if (buffer.empty()) return;
+
+	std::stable_sort(buffer.begin(), buffer.end(), [](Write const& a, Write const& b) { return a.key < b.key; });
+
+	typename map_type::iterator hint = entries.end();
+	for (std::size_t i = 0; i < buffer.size(); ++i) {
+		// Only the newest write of each key run counts
+		if (i + 1 < buffer.size() && !(buffer[i].key < buffer[i + 1].key)) continue;
+
+		Write& w = buffer[i];
+		if (!w.erase) {
+			hint = entries.insert(hint, w.key, w.value);
+			continue;
+		}
+
+		typename map_type::iterator it = entries.find_near(hint, w.key);
+		if (it != entries.end()) {
+			hint = it;
+			++hint; // Erase relinks nodes, so the successor stays valid
+			entries.erase(it);
+		}
+	}
+	buffer.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Size
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+std::size_t CS280::BufferedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE>::size() {
+	flush();
+	return entries.size();
+}
+
+//-----------------------------------------------------------------------------
+// Ordered For Each
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+template<typename FN>
+void CS280::BufferedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE>::for_each(FN fn) {
+	flush();
+	for (typename map_type::iterator it = entries.begin(); it != entries.end(); ++it) {
+		fn(it->Key(), it->Value());
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Underlying AVLmap
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+typename CS280::BufferedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE>::map_type& CS280::BufferedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE>::map() {
+	flush();
+	return entries;
+}
+
+//-----------------------------------------------------------------------------
+// Buffered writes
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+std::size_t CS280::BufferedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE>::buffered() const {
+	return buffer.size();
+}
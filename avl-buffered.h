@@ -0,0 +1,73 @@
+/*!*****************************************************************************
+*\file     avl-buffered.h
+*\author   Jalin A. Brown
+*\brief Description:
+	AVLmap with a write-combining front buffer for insert heavy ingest.
+
+	Writes (insert / overwrite / erase) are appended to a small unsorted
+	buffer instead of descending the tree. Reads scan the buffer newest
+	first and fall back to the tree, so every write is visible at once.
+	When the buffer is full it is sorted, the last write per key is kept,
+	and the survivors are merged into the tree in key order with hinted
+	inserts, so consecutive merges start next to each other instead of
+	at the root.
+
+	Keep the buffer small enough to stay in cache (the default is 1024
+	entries): reads pay a linear scan of it.
+******************************************************************************/
+
+#ifndef AVLBUFFERED_H
+#define AVLBUFFERED_H
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl.h"
+
+namespace CS280 {
+		//-----------------------------------------------------------------------------
+		// BufferedAVLmap class declarations
+		//-----------------------------------------------------------------------------
+		template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT = AutoValues<>, typename AGGREGATE = NoAggregate>
+		class BufferedAVLmap {
+		public:
+			typedef AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE> map_type;
+
+			explicit BufferedAVLmap(std::size_t bufferEntries = 1024);
+
+			// Writes - buffered, merged by flush() or when the buffer fills
+			void insert(KEY_TYPE const& key, VALUE_TYPE const& value); // overwrites like AVLmap::insert
+			void erase(KEY_TYPE const& key);
+
+			// Reads - buffer first (newest write wins), then the tree.
+			// The pointer is valid until the next write.
+			VALUE_TYPE const* find(KEY_TYPE const& key);
+			bool contains(KEY_TYPE const& key);
+
+			// Merge the buffer into the tree
+			void flush();
+
+			// Getters (these flush so the tree is complete)
+			std::size_t size();
+			template<typename FN>
+			void for_each(FN fn); // fn(key, value&) in key order
+			map_type& map();
+
+			std::size_t buffered() const; // writes waiting in the buffer
+
+		private:
+			struct Write {
+				KEY_TYPE   key;
+				VALUE_TYPE value;
+				bool       erase;
+			};
+
+			std::vector<Write> buffer; // append order = write order
+			std::size_t bufferEntries;
+			map_type entries;
+	};
+}
+
+#include "avl-buffered.cpp"
+#endif
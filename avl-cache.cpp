@@ -0,0 +1,276 @@
+/*!*****************************************************************************
+*\file     avl-cache.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	Bounded ordered cache built on AVLmap.
+
+	List operations are O(1) pointer splices on the Entry links. Evicting
+	an entry erases its node from the AVLmap, O(log n).
+******************************************************************************/
+
+#include "avl-cache.h"
+
+/*!****************************************************************************
+// Class AVLcache Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// CTOR
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::AVLcache(std::size_t capacity, std::size_t byteBudget, clock::duration ttl)
+	: capacity((capacity) ? capacity : 1), byteBudget(byteBudget), ttl(ttl),
+	  sizer([](KEY_TYPE const&, VALUE_TYPE const&) { return sizeof(Node); }) {
+}
+
+//-----------------------------------------------------------------------------
+// Insert - overwrites, refreshes recency and expiry, then evicts
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+void CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::insert(KEY_TYPE const& key, VALUE_TYPE const& value) {
+	admit(key, value);
+}
+
+//-----------------------------------------------------------------------------
+// Find - a hit becomes most recent; an expired hit is dropped
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+VALUE_TYPE* CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::find(KEY_TYPE const& key) {
+	typename map_type::iterator it = entries.find(key);
+	if (it == entries.end()) return nullptr;
+
+	Entry& e = it->Value();
+	if (expired(e, clock::now())) {
+		evict(e);
+		return nullptr;
+	}
+	touch(e);
+	return &e.value;
+}
+
+//-----------------------------------------------------------------------------
+// Operator[] - a miss admits a default value (expiry restarts only on writes
+// through insert or a miss, writes through the reference are not seen)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+VALUE_TYPE& CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::operator[](KEY_TYPE const& key) {
+	if (VALUE_TYPE* value = find(key)) {
+		return *value;
+	}
+	return admit(key, VALUE_TYPE()).value;
+}
+
+//-----------------------------------------------------------------------------
+// Erase - returns true if the key was cached
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::erase(KEY_TYPE const& key) {
+	typename map_type::iterator it = entries.find(key);
+	if (it == entries.end()) return false;
+	evict(it->Value());
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Drop expired entries from the head of the expiry list
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+std::size_t CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::evictExpired() {
+	return dropExpired(nullptr);
+}
+
+//-----------------------------------------------------------------------------
+// Ordered For Each
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+template<typename FN>
+void CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::for_each(FN fn) {
+	for (typename map_type::iterator it = entries.begin(); it != entries.end(); ++it) {
+		fn(it->Key(), it->Value().value);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Ordered For Each over keys in [lo, hi]
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+template<typename FN>
+void CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::for_each_range(KEY_TYPE const& lo, KEY_TYPE const& hi, FN fn) {
+	// Lower bound: first node with key >= lo
+	Node* first = nullptr;
+	for (Node* N = entries.getRoot(); N; ) {
+		if (N->Key() < lo) {
+			N = N->Right();
+		}
+		else {
+			first = N;
+			N = N->Left();
+		}
+	}
+
+	for (Node* N = first; N && !(hi < N->Key()); N = N->increment()) {
+		fn(N->Key(), N->Value().value);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Size
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+std::size_t CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::size() {
+	return entries.size();
+}
+
+//-----------------------------------------------------------------------------
+// Bytes charged against the budget
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+std::size_t CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::bytes() const {
+	return usedBytes;
+}
+
+//-----------------------------------------------------------------------------
+// Sizer Setter (applies to entries written from now on)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+void CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::setSizer(sizer_type newSizer) {
+	sizer = newSizer;
+}
+
+/*!****************************************************************************
+// Class AVLcache Private Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Store key/value, make it most recent, restart its expiry, enforce limits
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::Entry& CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::admit(KEY_TYPE const& key, VALUE_TYPE const& value) {
+	typename map_type::iterator it = entries.find(key);
+	if (it == entries.end()) {
+		it = entries.insert(entries.end(), key, Entry(value));
+		it->Value().key = &it->Key();
+	}
+	else {
+		it->Value().value = value;
+		usedBytes -= it->Value().bytes;
+	}
+
+	Entry& e = it->Value();
+	e.bytes = sizer(key, value);
+	usedBytes += e.bytes;
+	touch(e);
+	linkExpiry(e);
+	enforceLimits(e);
+	return e;
+}
+
+//-----------------------------------------------------------------------------
+// Move an entry to the front of the recency list
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+void CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::touch(Entry& e) {
+	if (mostRecent == &e) return;
+
+	// Unlink (a new entry has no neighbours and is not the tail)
+	if (e.newer) e.newer->older = e.older;
+	if (e.older) e.older->newer = e.newer;
+	if (leastRecent == &e) leastRecent = e.newer;
+
+	// Push front
+	e.newer = nullptr;
+	e.older = mostRecent;
+	if (mostRecent) mostRecent->newer = &e;
+	mostRecent = &e;
+	if (!leastRecent) leastRecent = &e;
+}
+
+//-----------------------------------------------------------------------------
+// Stamp a new expiry and move the entry to the tail of the expiry list
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+void CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::linkExpiry(Entry& e) {
+	if (ttl == clock::duration::zero()) return;
+
+	e.expiry = clock::now() + ttl;
+	if (lastExpiry == &e) return;
+
+	// Unlink
+	if (e.prevExpiry) e.prevExpiry->nextExpiry = e.nextExpiry;
+	if (e.nextExpiry) e.nextExpiry->prevExpiry = e.prevExpiry;
+	if (firstExpiry == &e) firstExpiry = e.nextExpiry;
+
+	// Append
+	e.nextExpiry = nullptr;
+	e.prevExpiry = lastExpiry;
+	if (lastExpiry) lastExpiry->nextExpiry = &e;
+	lastExpiry = &e;
+	if (!firstExpiry) firstExpiry = &e;
+}
+
+//-----------------------------------------------------------------------------
+// Remove an entry from both lists
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+void CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::unlink(Entry& e) {
+	if (e.newer) e.newer->older = e.older;
+	else         mostRecent = e.older;
+	if (e.older) e.older->newer = e.newer;
+	else         leastRecent = e.newer;
+
+	if (ttl != clock::duration::zero()) {
+		if (e.prevExpiry) e.prevExpiry->nextExpiry = e.nextExpiry;
+		else              firstExpiry = e.nextExpiry;
+		if (e.nextExpiry) e.nextExpiry->prevExpiry = e.prevExpiry;
+		else              lastExpiry = e.prevExpiry;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Unlink and erase the node holding the entry, O(log n)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+void CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::evict(Entry& e) {
+	unlink(e);
+	usedBytes -= e.bytes;
+	entries.erase(entries.find(*e.key));
+}
+
+//-----------------------------------------------------------------------------
+// Drop expired entries, then least recent ones until within capacity and
+// byte budget; `keep` (the entry just written) is never evicted
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+void CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::enforceLimits(Entry const& keep) {
+	dropExpired(&keep);
+	while (leastRecent && leastRecent != &keep &&
+	       (entries.size() > capacity || (byteBudget && usedBytes > byteBudget))) {
+		evict(*leastRecent);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Drop expired entries from the head of the expiry list, stopping at `keep`
+// (a fresh write sits at the tail, so a very short ttl can expire it before
+// the sweep; it must survive until the caller has used it)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+std::size_t CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::dropExpired(Entry const* keep) {
+	std::size_t dropped = 0;
+	if (ttl == clock::duration::zero()) return dropped;
+
+	clock::time_point now = clock::now();
+	while (firstExpiry && firstExpiry != keep && expired(*firstExpiry, now)) {
+		evict(*firstExpiry);
+		++dropped;
+	}
+	return dropped;
+}
+
+//-----------------------------------------------------------------------------
+// Has the entry expired
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::AVLcache<KEY_TYPE, VALUE_TYPE>::expired(Entry const& e, clock::time_point now) const {
+	return ttl != clock::duration::zero() && !(now < e.expiry);
+}
@@ -0,0 +1,108 @@
+/*!*****************************************************************************
+*\file     avl-cache.h
+*\author   Jalin A. Brown
+*\brief Description:
+	Bounded ordered cache built on AVLmap.
+
+	Each map value carries intrusive links, so recency and expiry lists live
+	inside the tree nodes instead of a separate list and hash map:
+	1) recency list - find / operator[] / insert move the entry to the front
+	   in O(1); when capacity or the byte budget is exceeded the least
+	   recently used entry is erased, O(log n)
+	2) expiry list  - with a ttl every entry expires ttl after it was last
+	   written; since the ttl is shared, write order is expiry order and
+	   expired entries are dropped from the head of the list
+	Ordered iteration and key range walks go through the AVLmap as usual.
+******************************************************************************/
+
+#ifndef AVLCACHE_H
+#define AVLCACHE_H
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl.h"
+#include <chrono>			// std::chrono::steady_clock
+#include <functional> // std::function
+
+namespace CS280 {
+		//-----------------------------------------------------------------------------
+		// AVLcache class declarations
+		//-----------------------------------------------------------------------------
+		template<typename KEY_TYPE, typename VALUE_TYPE>
+		class AVLcache {
+		public:
+			typedef std::chrono::steady_clock clock;
+
+			//-----------------------------------------------------------------------------
+			// Entry - the AVLmap value: user value plus intrusive links. Entries never
+			// move once linked (AVLmap erase relinks nodes instead of copying).
+			//-----------------------------------------------------------------------------
+			struct Entry {
+				explicit Entry(VALUE_TYPE const& v = VALUE_TYPE()) : value(v) {}
+
+				VALUE_TYPE        value;
+				KEY_TYPE const*   key         = nullptr; // points at the node key
+				Entry*            newer       = nullptr; // recency list
+				Entry*            older       = nullptr;
+				Entry*            nextExpiry  = nullptr; // expiry list (write order)
+				Entry*            prevExpiry  = nullptr;
+				clock::time_point expiry;
+				std::size_t       bytes       = 0;
+			};
+
+			typedef AVLmap<KEY_TYPE, Entry, InlineValues> map_type;
+			typedef std::function<std::size_t(KEY_TYPE const&, VALUE_TYPE const&)> sizer_type;
+
+			// BIG FOUR
+			explicit AVLcache(std::size_t capacity, std::size_t byteBudget = 0, clock::duration ttl = clock::duration::zero());
+			AVLcache(const AVLcache&)            = delete;
+			AVLcache& operator=(const AVLcache&) = delete;
+			~AVLcache() = default;
+
+			// Cache operations
+			void insert(KEY_TYPE const& key, VALUE_TYPE const& value);
+			VALUE_TYPE* find(KEY_TYPE const& key);        // nullptr if missing or expired
+			VALUE_TYPE& operator[](KEY_TYPE const& key);
+			bool erase(KEY_TYPE const& key);
+			std::size_t evictExpired();                   // returns entries dropped
+
+			// Ordered walks (do not touch recency)
+			template<typename FN>
+			void for_each(FN fn);                         // fn(key, value&)
+			template<typename FN>
+			void for_each_range(KEY_TYPE const& lo, KEY_TYPE const& hi, FN fn); // keys in [lo, hi]
+
+			// Getters / Setters
+			std::size_t size();
+			std::size_t bytes() const;
+			void setSizer(sizer_type sizer); // bytes charged per entry (default: node size)
+
+		private:
+			typedef typename map_type::Node Node;
+
+			Entry& admit(KEY_TYPE const& key, VALUE_TYPE const& value); // insert + link + evict
+			void touch(Entry& e);              // move to the front of the recency list
+			void linkExpiry(Entry& e);         // (re)stamp and move to the expiry tail
+			void unlink(Entry& e);             // remove from both lists
+			void evict(Entry& e);              // unlink and erase from the map
+			void enforceLimits(Entry const& keep);
+			std::size_t dropExpired(Entry const* keep); // nullptr = drop every expired entry
+			bool expired(Entry const& e, clock::time_point now) const;
+
+			map_type entries;
+			Entry* mostRecent  = nullptr;
+			Entry* leastRecent = nullptr;
+			Entry* firstExpiry = nullptr;
+			Entry* lastExpiry  = nullptr;
+			std::size_t capacity;
+			std::size_t byteBudget; // 0 = no byte limit
+			std::size_t usedBytes = 0;
+			clock::duration ttl;    // zero = entries never expire
+			sizer_type sizer;
+	};
+}
+
+#include "avl-cache.cpp"
+#endif
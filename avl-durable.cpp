@@ -0,0 +1,355 @@
+/*!*****************************************************************************
+*\file     avl-durable.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	Durable AVLmap: write-ahead log plus sorted checkpoints (POSIX files).
+
+	Record layout (log and checkpoint alike):
+		[type : 1][length : 4][payload : length][checksum : 4]
+	payload = key, then value for Put records; checksum = FNV-1a over
+	type, length and payload. The checkpoint starts with checkpointMagic.
+******************************************************************************/
+
+#include "avl-durable.h"
+#include <vector>			 // std::vector
+#include <cstdio>			 // std::rename
+#include <cerrno>			 // errno
+#include <fcntl.h>		 // open
+#include <unistd.h>		 // write, read, fsync, ftruncate, close
+#include <sys/stat.h>	 // mkdir
+
+namespace CS280 {
+	static char const checkpointMagic[8] = { 'A', 'V', 'L', 'C', 'K', 'P', 'T', '1' };
+}
+
+/*!****************************************************************************
+// Class DurableAVLmap Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// CTOR
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::DurableAVLmap(DurableOptions options) : options(options) {
+}
+
+//-----------------------------------------------------------------------------
+// ~DTOR
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::~DurableAVLmap() {
+	close();
+}
+
+//-----------------------------------------------------------------------------
+// Open - load the checkpoint, replay the log, cut off a torn tail
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::open(std::string const& dir) {
+	close();
+	directory = dir;
+	if (::mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+		return false;
+	}
+
+	// Checkpoint: strictly ascending Put records, bulk loaded in O(n)
+	std::string data;
+	std::vector<std::pair<KEY_TYPE, VALUE_TYPE>> sorted;
+	if (readFile(directory + "/checkpoint", data)) {
+		std::size_t goodBytes = 0;
+		if (data.size() < sizeof(checkpointMagic) ||
+		    std::memcmp(data.data(), checkpointMagic, sizeof(checkpointMagic)) != 0 ||
+		    !parse(data, sizeof(checkpointMagic), goodBytes,
+		           [&sorted](RecordType, KEY_TYPE const& key, VALUE_TYPE const* value) {
+		             sorted.push_back(std::make_pair(key, *value));
+		           })) {
+			return false; // Checkpoints are renamed into place whole, so this is corruption
+		}
+	}
+	entries.assignSorted(sorted.begin(), sorted.end());
+
+	// Log: replay until the first bad record
+	std::size_t goodBytes = 0;
+	if (readFile(directory + "/wal", data)) {
+		parse(data, 0, goodBytes, [this](RecordType type, KEY_TYPE const& key, VALUE_TYPE const* value) {
+			if (type == Put) {
+				entries.insert(key, *value);
+			}
+			else {
+				entries.erase(entries.find(key));
+			}
+		});
+	}
+
+	logFd = ::open((directory + "/wal").c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+	if (logFd < 0) return false;
+	if (::ftruncate(logFd, static_cast<off_t>(goodBytes)) != 0) return false;
+	logBytes = goodBytes;
+	lastSync = std::chrono::steady_clock::now();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Close - commit what is batched and release the log
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+void CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::close() {
+	if (logFd < 0) return;
+	commit();
+	::close(logFd);
+	logFd = -1;
+}
+
+//-----------------------------------------------------------------------------
+// Insert (overwrites like AVLmap::insert)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::insert(KEY_TYPE const& key, VALUE_TYPE const& value) {
+	entries.insert(key, value);
+	append(Put, key, &value);
+	return (batch.size() < options.groupCommitBytes) ? true : commit();
+}
+
+//-----------------------------------------------------------------------------
+// Erase - logged only when the key was present
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::erase(KEY_TYPE const& key) {
+	typename map_type::iterator it = entries.find(key);
+	if (it == entries.end()) return true;
+	entries.erase(it);
+	append(Erase, key, nullptr);
+	return (batch.size() < options.groupCommitBytes) ? true : commit();
+}
+
+//-----------------------------------------------------------------------------
+// Update - the operator[] path: fn edits the value, the result is logged
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+template<typename FN>
+bool CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::update(KEY_TYPE const& key, FN fn) {
+	VALUE_TYPE& value = entries[key];
+	fn(value);
+	append(Put, key, &value);
+	return (batch.size() < options.groupCommitBytes) ? true : commit();
+}
+
+//-----------------------------------------------------------------------------
+// Group Commit - one write for the whole batch, then sync per policy
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::commit() {
+	if (logFd < 0) return false;
+	if (!batch.empty()) {
+		if (!writeFile(logFd, batch)) return false;
+		logBytes += batch.size();
+		batch.clear();
+
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		bool sync = (options.sync == SyncPolicy::OnCommit) ||
+		            (options.sync == SyncPolicy::Periodic && now - lastSync >= options.syncInterval);
+		if (sync) {
+			if (::fsync(logFd) != 0) return false;
+			lastSync = now;
+		}
+	}
+
+	if (logBytes >= options.checkpointBytes) {
+		return checkpoint();
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Checkpoint - write all entries in key order to a temporary file, rename it
+// over the old checkpoint, then empty the log
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::checkpoint() {
+	if (logFd < 0) return false;
+	if (!batch.empty()) {
+		if (!writeFile(logFd, batch)) return false;
+		logBytes += batch.size();
+		batch.clear();
+	}
+
+	std::string tmpPath = directory + "/checkpoint.tmp";
+	int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) return false;
+
+	// Stream the snapshot out in groupCommitBytes sized writes
+	std::string buffer(checkpointMagic, sizeof(checkpointMagic));
+	bool ok = true;
+	for (typename map_type::iterator it = entries.begin(); ok && it != entries.end(); ++it) {
+		batch.clear();
+		append(Put, it->Key(), &it->Value());
+		buffer += batch;
+		if (buffer.size() >= options.groupCommitBytes) {
+			ok = writeFile(fd, buffer);
+			buffer.clear();
+		}
+	}
+	batch.clear();
+	ok = ok && writeFile(fd, buffer) && ::fsync(fd) == 0;
+	::close(fd);
+	if (!ok) return false;
+
+	if (std::rename(tmpPath.c_str(), (directory + "/checkpoint").c_str()) != 0) return false;
+	if (!syncDirectory()) return false;
+
+	// The checkpoint now holds everything in the log
+	if (::ftruncate(logFd, 0) != 0 || ::fsync(logFd) != 0) return false;
+	logBytes = 0;
+	lastSync = std::chrono::steady_clock::now();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Find
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+VALUE_TYPE const* CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::find(KEY_TYPE const& key) {
+	typename map_type::iterator it = entries.find(key);
+	return (it == entries.end()) ? nullptr : &it->Value();
+}
+
+//-----------------------------------------------------------------------------
+// Size
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+std::size_t CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::size() {
+	return entries.size();
+}
+
+//-----------------------------------------------------------------------------
+// Underlying AVLmap
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::map_type& CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::map() {
+	return entries;
+}
+
+/*!****************************************************************************
+// Class DurableAVLmap Private Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Encode one record onto the batch
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+void CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::append(RecordType type, KEY_TYPE const& key, VALUE_TYPE const* value) {
+	std::size_t start = batch.size();
+	batch.push_back(static_cast<char>(type));
+	batch.append(4, '\0'); // Length, patched below
+
+	DurableCodec<KEY_TYPE>::write(batch, key);
+	if (value) {
+		DurableCodec<VALUE_TYPE>::write(batch, *value);
+	}
+
+	std::uint32_t length = static_cast<std::uint32_t>(batch.size() - start - 5);
+	std::memcpy(&batch[start + 1], &length, sizeof(length));
+	DurableCodec<std::uint32_t>::write(batch, checksum(batch.data() + start, batch.size() - start));
+}
+
+//-----------------------------------------------------------------------------
+// Decode records from offset; goodBytes = end of the last intact record.
+// Returns false if the data ends in a torn or corrupt record.
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+template<typename FN>
+bool CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::parse(std::string const& data, std::size_t offset, std::size_t& goodBytes, FN fn) {
+	char const* base = data.data();
+	goodBytes = offset;
+	while (offset < data.size()) {
+		char const* p = base + offset;
+		char const* end = base + data.size();
+
+		// Header, then check the whole record before decoding it
+		std::uint32_t length, stored;
+		if (end - p < 5) return false;
+		RecordType type = static_cast<RecordType>(p[0]);
+		std::memcpy(&length, p + 1, sizeof(length));
+		if (static_cast<std::size_t>(end - p) < 5 + static_cast<std::size_t>(length) + 4) return false;
+		std::memcpy(&stored, p + 5 + length, sizeof(stored));
+		if (stored != checksum(p, 5 + length)) return false;
+		if (type != Put && type != Erase) return false;
+
+		char const* q = p + 5;
+		char const* payloadEnd = q + length;
+		KEY_TYPE key;
+		VALUE_TYPE value;
+		if (!DurableCodec<KEY_TYPE>::read(q, payloadEnd, key)) return false;
+		if (type == Put && !DurableCodec<VALUE_TYPE>::read(q, payloadEnd, value)) return false;
+		fn(type, key, (type == Put) ? &value : nullptr);
+
+		offset += 5 + length + 4;
+		goodBytes = offset;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Write all of data, retrying short writes
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::writeFile(int fd, std::string const& data) {
+	char const* p = data.data();
+	std::size_t left = data.size();
+	while (left > 0) {
+		ssize_t written = ::write(fd, p, left);
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			return false;
+		}
+		p += written;
+		left -= static_cast<std::size_t>(written);
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Read a whole file; false if it does not exist or cannot be read
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::readFile(std::string const& path, std::string& data) {
+	data.clear();
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	char chunk[64 * 1024];
+	for (;;) {
+		ssize_t got = ::read(fd, chunk, sizeof(chunk));
+		if (got < 0 && errno == EINTR) continue;
+		if (got <= 0) {
+			::close(fd);
+			return got == 0;
+		}
+		data.append(chunk, static_cast<std::size_t>(got));
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Make the checkpoint rename durable
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::syncDirectory() {
+	int fd = ::open(directory.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	bool ok = ::fsync(fd) == 0;
+	::close(fd);
+	return ok;
+}
+
+//-----------------------------------------------------------------------------
+// FNV-1a, 32 bit
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE>
+std::uint32_t CS280::DurableAVLmap<KEY_TYPE, VALUE_TYPE>::checksum(char const* data, std::size_t length) {
+	std::uint32_t hash = 2166136261u;
+	for (std::size_t i = 0; i < length; ++i) {
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= 16777619u;
+	}
+	return hash;
+}
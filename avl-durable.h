@@ -0,0 +1,148 @@
+/*!*****************************************************************************
+*\file     avl-durable.h
+*\author   Jalin A. Brown
+*\brief Description:
+	Durable AVLmap: write-ahead log plus sorted checkpoints (POSIX files).
+
+	1) Every insert / erase / update appends a checksummed record to an
+	   in-memory batch; commit() writes the batch to <dir>/wal in one write
+	   (group commit) and syncs it according to the SyncPolicy.
+	2) Once the log passes checkpointBytes, checkpoint() writes every entry
+	   in key order to <dir>/checkpoint (via a temporary file and rename)
+	   and truncates the log.
+	3) open() recovers by bulk loading the checkpoint (AVLmap::assignSorted)
+	   and replaying the log; a torn record at the log tail is cut off.
+
+	Records that are still in the batch are lost on a crash - call commit()
+	where durability is required. Replaying a log over a checkpoint that
+	already contains it gives the same map, so a crash between the rename
+	and the truncate is harmless.
+******************************************************************************/
+
+#ifndef AVLDURABLE_H
+#define AVLDURABLE_H
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl.h"
+#include <string>				// std::string
+#include <chrono>				// std::chrono::steady_clock
+#include <cstring>			// std::memcpy
+#include <cstdint>			// std::uint32_t
+
+namespace CS280 {
+		//-----------------------------------------------------------------------------
+		// DurableCodec - byte encoding of keys and values. Trivially copyable types
+		// and std::string are provided; specialize for anything else.
+		//   write(out, v)          append the encoding of v to out
+		//   read(p, end, v)        decode from [p, end), advance p, false if short
+		//-----------------------------------------------------------------------------
+		template<typename T, typename ENABLE = void>
+		struct DurableCodec;
+
+		template<typename T>
+		struct DurableCodec<T, typename std::enable_if<std::is_trivially_copyable<T>::value>::type> {
+			static void write(std::string& out, T const& v) {
+				out.append(reinterpret_cast<char const*>(&v), sizeof(T));
+			}
+			static bool read(char const*& p, char const* end, T& v) {
+				if (static_cast<std::size_t>(end - p) < sizeof(T)) return false;
+				std::memcpy(&v, p, sizeof(T));
+				p += sizeof(T);
+				return true;
+			}
+		};
+
+		template<>
+		struct DurableCodec<std::string> {
+			static void write(std::string& out, std::string const& v) {
+				DurableCodec<std::uint32_t>::write(out, static_cast<std::uint32_t>(v.size()));
+				out.append(v);
+			}
+			static bool read(char const*& p, char const* end, std::string& v) {
+				std::uint32_t length;
+				if (!DurableCodec<std::uint32_t>::read(p, end, length)) return false;
+				if (static_cast<std::size_t>(end - p) < length) return false;
+				v.assign(p, length);
+				p += length;
+				return true;
+			}
+		};
+
+		//-----------------------------------------------------------------------------
+		// SyncPolicy - when committed log data is fsync'ed
+		//-----------------------------------------------------------------------------
+		enum class SyncPolicy {
+			Never,    // leave it to the OS (survives a process crash, not power loss)
+			OnCommit, // fsync after every commit()
+			Periodic  // fsync at commit() when syncInterval has passed since the last one
+		};
+
+		//-----------------------------------------------------------------------------
+		// DurableOptions
+		//-----------------------------------------------------------------------------
+		struct DurableOptions {
+			SyncPolicy                sync             = SyncPolicy::OnCommit;
+			std::size_t               groupCommitBytes = 64 * 1024;        // batch size that forces a commit
+			std::chrono::milliseconds syncInterval     = std::chrono::milliseconds(100);
+			std::size_t               checkpointBytes  = 64 * 1024 * 1024; // log size that forces a checkpoint
+		};
+
+		//-----------------------------------------------------------------------------
+		// DurableAVLmap class declarations
+		//-----------------------------------------------------------------------------
+		template<typename KEY_TYPE, typename VALUE_TYPE>
+		class DurableAVLmap {
+		public:
+			typedef AVLmap<KEY_TYPE, VALUE_TYPE> map_type;
+
+			// BIG FOUR
+			explicit DurableAVLmap(DurableOptions options = DurableOptions());
+			DurableAVLmap(const DurableAVLmap&)            = delete;
+			DurableAVLmap& operator=(const DurableAVLmap&) = delete;
+			~DurableAVLmap(); // commits and closes
+
+			// Files (false on I/O error or a corrupt checkpoint)
+			bool open(std::string const& directory); // creates the directory or recovers from it
+			void close();
+
+			// Mutations - applied in memory and batched for the log
+			bool insert(KEY_TYPE const& key, VALUE_TYPE const& value);
+			bool erase(KEY_TYPE const& key);
+			template<typename FN>
+			bool update(KEY_TYPE const& key, FN fn); // fn(operator[](key)), then logs the result
+
+			// Durability
+			bool commit();     // write the batch, sync per policy, checkpoint if due
+			bool checkpoint(); // sorted snapshot, then truncate the log
+
+			// Getters
+			VALUE_TYPE const* find(KEY_TYPE const& key);
+			std::size_t size();
+			map_type& map(); // read access; writes made here are not logged
+
+		private:
+			enum RecordType : char { Put = 1, Erase = 2 };
+
+			void append(RecordType type, KEY_TYPE const& key, VALUE_TYPE const* value);
+			template<typename FN>
+			bool parse(std::string const& data, std::size_t offset, std::size_t& goodBytes, FN fn); // fn(type, key, value)
+			bool syncDirectory();
+			bool writeFile(int fd, std::string const& data);
+			bool readFile(std::string const& path, std::string& data);
+			static std::uint32_t checksum(char const* data, std::size_t length);
+
+			map_type entries;
+			DurableOptions options;
+			std::string directory;
+			std::string batch;           // encoded records not yet written
+			std::size_t logBytes = 0;    // bytes in <dir>/wal
+			int logFd = -1;
+			std::chrono::steady_clock::time_point lastSync;
+	};
+}
+
+#include "avl-durable.cpp"
+#endif
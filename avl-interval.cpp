@@ -0,0 +1,135 @@
+/*!*****************************************************************************
+*\file     avl-interval.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	Interval map built on AVLmap.
+
+	Both queries lean on the same two facts: a subtree whose max high is
+	below `low` cannot overlap, and nothing to the right of a node whose
+	low is above `high` can overlap.
+******************************************************************************/
+
+#include "avl-interval.h"
+#include <stack> // std::stack
+
+/*!****************************************************************************
+// Interval Comparison Operators
+******************************************************************************/
+
+template<typename POINT_TYPE>
+bool CS280::operator<(Interval<POINT_TYPE> const& a, Interval<POINT_TYPE> const& b) {
+	if (a.low < b.low) return true;
+	if (b.low < a.low) return false;
+	return a.high < b.high;
+}
+
+template<typename POINT_TYPE>
+bool CS280::operator>(Interval<POINT_TYPE> const& a, Interval<POINT_TYPE> const& b) {
+	return b < a;
+}
+
+template<typename POINT_TYPE>
+bool CS280::operator==(Interval<POINT_TYPE> const& a, Interval<POINT_TYPE> const& b) {
+	return !(a < b) && !(b < a);
+}
+
+/*!****************************************************************************
+// Class IntervalMap Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Insert
+//-----------------------------------------------------------------------------
+template<typename POINT_TYPE, typename VALUE_TYPE, typename LAYOUT>
+void CS280::IntervalMap<POINT_TYPE, VALUE_TYPE, LAYOUT>::insert(POINT_TYPE const& low, POINT_TYPE const& high, VALUE_TYPE const& value) {
+	intervals.insert(interval_type{ low, high }, value);
+}
+
+//-----------------------------------------------------------------------------
+// Erase - returns true if [low, high] was stored
+//-----------------------------------------------------------------------------
+template<typename POINT_TYPE, typename VALUE_TYPE, typename LAYOUT>
+bool CS280::IntervalMap<POINT_TYPE, VALUE_TYPE, LAYOUT>::erase(POINT_TYPE const& low, POINT_TYPE const& high) {
+	typename map_type::iterator it = intervals.find(interval_type{ low, high });
+	if (it == intervals.end()) return false;
+	intervals.erase(it);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Any Overlap - single root to leaf walk.
+// If the left subtree reaches `low` but holds no overlap, every interval
+// there that reaches `low` starts after `high`, and so does everything to
+// the right; going left is therefore always enough.
+//-----------------------------------------------------------------------------
+template<typename POINT_TYPE, typename VALUE_TYPE, typename LAYOUT>
+bool CS280::IntervalMap<POINT_TYPE, VALUE_TYPE, LAYOUT>::overlaps(POINT_TYPE const& low, POINT_TYPE const& high) const {
+	Node* N = intervals.getRoot();
+	while (N) {
+		interval_type const& key = N->Key();
+		if (!(high < key.low) && !(key.high < low)) {
+			return true;
+		}
+		if (N->Left() && !(N->Left()->Aggregate() < low)) {
+			N = N->Left();
+		}
+		else {
+			N = N->Right();
+		}
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// All Overlaps - in-order walk that skips subtrees ending before `low` and
+// stops at the first interval starting after `high`
+//-----------------------------------------------------------------------------
+template<typename POINT_TYPE, typename VALUE_TYPE, typename LAYOUT>
+template<typename FN>
+void CS280::IntervalMap<POINT_TYPE, VALUE_TYPE, LAYOUT>::for_each_overlap(POINT_TYPE const& low, POINT_TYPE const& high, FN fn) {
+	std::stack<Node*> pending;
+	Node* N = intervals.getRoot();
+	for (;;) {
+		// Go left only into subtrees that still reach `low`
+		while (N && !(N->Aggregate() < low)) {
+			pending.push(N);
+			N = N->Left();
+		}
+		if (pending.empty()) break;
+
+		N = pending.top();
+		pending.pop();
+		if (high < N->Key().low) break; // Everything after starts too late
+
+		if (!(N->Key().high < low)) {
+			fn(N->Key(), N->Value());
+		}
+		N = N->Right();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// All Overlaps, collected in key order
+//-----------------------------------------------------------------------------
+template<typename POINT_TYPE, typename VALUE_TYPE, typename LAYOUT>
+std::vector<typename CS280::IntervalMap<POINT_TYPE, VALUE_TYPE, LAYOUT>::interval_type> CS280::IntervalMap<POINT_TYPE, VALUE_TYPE, LAYOUT>::overlapping(POINT_TYPE const& low, POINT_TYPE const& high) {
+	std::vector<interval_type> result;
+	for_each_overlap(low, high, [&result](interval_type const& key, VALUE_TYPE&) { result.push_back(key); });
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+// Size
+//-----------------------------------------------------------------------------
+template<typename POINT_TYPE, typename VALUE_TYPE, typename LAYOUT>
+std::size_t CS280::IntervalMap<POINT_TYPE, VALUE_TYPE, LAYOUT>::size() {
+	return intervals.size();
+}
+
+//-----------------------------------------------------------------------------
+// Underlying AVLmap
+//-----------------------------------------------------------------------------
+template<typename POINT_TYPE, typename VALUE_TYPE, typename LAYOUT>
+typename CS280::IntervalMap<POINT_TYPE, VALUE_TYPE, LAYOUT>::map_type& CS280::IntervalMap<POINT_TYPE, VALUE_TYPE, LAYOUT>::map() {
+	return intervals;
+}
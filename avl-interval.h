@@ -0,0 +1,94 @@
+/*!*****************************************************************************
+*\file     avl-interval.h
+*\author   Jalin A. Brown
+*\brief Description:
+	Interval map built on AVLmap.
+
+	Closed intervals [low, high] are the keys (ordered by low, then high) and
+	the MaxEndAggregate policy keeps the largest high of every subtree, so:
+	1) overlaps(a, b)          - any stored interval meets [a, b], O(log n)
+	2) for_each_overlap(a, b)  - visit every overlapping interval in order,
+	                             O(log n + k log(n / k)) for k results
+	                             (never more than n)
+
+	for_each_overlap() does not reach O(log n + k). The walk only enters
+	subtrees whose max end reaches `low` and stops at the first interval
+	starting after `high`, but a subtree can hold one overlapping interval
+	under a path of nodes that end too early, and pruning by the subtree
+	min low adds nothing while keys are ordered by low. Every node visited
+	is on the search path for `high` or above a result, and the paths above
+	k results in a balanced tree share all but O(k log(n / k)) nodes. The
+	O(log n + k) bound takes a different structure (a priority search tree
+	or a centred interval tree), not a max-end aggregate on this map.
+******************************************************************************/
+
+#ifndef AVLINTERVAL_H
+#define AVLINTERVAL_H
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl.h"
+
+namespace CS280 {
+		//-----------------------------------------------------------------------------
+		// Interval struct declarations
+		//-----------------------------------------------------------------------------
+		template<typename POINT_TYPE>
+		struct Interval {
+			POINT_TYPE low;
+			POINT_TYPE high;
+		};
+
+		// Ordered by low, then high (the AVLmap key order)
+		template<typename POINT_TYPE>
+		bool operator<(Interval<POINT_TYPE> const& a, Interval<POINT_TYPE> const& b);
+		template<typename POINT_TYPE>
+		bool operator>(Interval<POINT_TYPE> const& a, Interval<POINT_TYPE> const& b);
+		template<typename POINT_TYPE>
+		bool operator==(Interval<POINT_TYPE> const& a, Interval<POINT_TYPE> const& b);
+
+		//-----------------------------------------------------------------------------
+		// MaxEndAggregate - largest high end point in a subtree
+		//-----------------------------------------------------------------------------
+		template<typename POINT_TYPE>
+		struct MaxEndAggregate {
+			static constexpr bool enabled = true;
+			typedef POINT_TYPE value_type;
+			template<typename VALUE_TYPE>
+			static value_type lift(Interval<POINT_TYPE> const& key, VALUE_TYPE const&) { return key.high; }
+			static value_type combine(value_type const& a, value_type const& b) { return (a < b) ? b : a; }
+		};
+
+		//-----------------------------------------------------------------------------
+		// IntervalMap class declarations
+		//-----------------------------------------------------------------------------
+		template<typename POINT_TYPE, typename VALUE_TYPE, typename LAYOUT = AutoValues<>>
+		class IntervalMap {
+		public:
+			typedef Interval<POINT_TYPE> interval_type;
+			typedef AVLmap<interval_type, VALUE_TYPE, LAYOUT, MaxEndAggregate<POINT_TYPE>> map_type;
+			typedef typename map_type::Node Node;
+
+			// Updates (an identical [low, high] overwrites the value, like AVLmap::insert)
+			void insert(POINT_TYPE const& low, POINT_TYPE const& high, VALUE_TYPE const& value);
+			bool erase(POINT_TYPE const& low, POINT_TYPE const& high);
+
+			// Queries against the closed interval [low, high]
+			bool overlaps(POINT_TYPE const& low, POINT_TYPE const& high) const;
+			template<typename FN>
+			void for_each_overlap(POINT_TYPE const& low, POINT_TYPE const& high, FN fn); // fn(interval_type const&, VALUE_TYPE&)
+			std::vector<interval_type> overlapping(POINT_TYPE const& low, POINT_TYPE const& high);
+
+			// Getters
+			std::size_t size();
+			map_type& map(); // ordered iteration over all intervals
+
+		private:
+			map_type intervals;
+	};
+}
+
+#include "avl-interval.cpp"
+#endif
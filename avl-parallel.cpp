@@ -0,0 +1,272 @@
+/*!*****************************************************************************
+*\file     avl-parallel.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	Parallel whole-map walks over an AVLmap.
+
+	Workers walk their subtrees with first() / increment(), the same parent
+	pointer walk the iterators use, so each task touches only its own nodes
+	and needs no locks. The calling thread is one of the workers.
+******************************************************************************/
+
+#include "avl-parallel.h"
+#include <mutex>        // std::mutex, std::lock_guard
+#include <exception>    // std::exception_ptr
+#include <system_error> // std::system_error
+#include <algorithm>    // std::move
+#include <iterator>     // std::back_inserter
+
+/*!****************************************************************************
+// Class AVLmapTasks Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// CTOR - split deep enough for ~8 tasks per thread (one task when serial)
+//-----------------------------------------------------------------------------
+template<typename NODE>
+CS280::AVLmapTasks<NODE>::AVLmapTasks(NODE* root, unsigned threads) : threads(threadCount(threads)) {
+	int depth = 0;
+	if (this->threads > 1) {
+		while ((std::size_t(1) << depth) < std::size_t(this->threads) * 8) {
+			++depth;
+		}
+	}
+	split(root, depth);
+}
+
+//-----------------------------------------------------------------------------
+// Size
+//-----------------------------------------------------------------------------
+template<typename NODE>
+std::size_t CS280::AVLmapTasks<NODE>::size() const {
+	return tasks.size();
+}
+
+//-----------------------------------------------------------------------------
+// Visit one task's nodes in key order
+//-----------------------------------------------------------------------------
+template<typename NODE>
+template<typename FN>
+void CS280::AVLmapTasks<NODE>::visit(std::size_t task, FN fn) const {
+	NODE* N = tasks[task].node;
+	if (!tasks[task].subtree) {
+		fn(N);
+		return;
+	}
+	NODE* last = N->last();
+	for (N = N->first(); ; N = N->increment()) {
+		fn(N);
+		if (N == last) break;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Run fn(task) for every task. Workers claim tasks from a shared counter;
+// the first exception stops further claims and is rethrown after the join.
+//-----------------------------------------------------------------------------
+template<typename NODE>
+template<typename FN>
+void CS280::AVLmapTasks<NODE>::run(FN fn) const {
+	if (threads <= 1 || tasks.size() <= 1) {
+		for (std::size_t i = 0; i < tasks.size(); ++i) {
+			fn(i);
+		}
+		return;
+	}
+
+	std::atomic<std::size_t> next(0);
+	std::exception_ptr error;
+	std::mutex errorLock;
+	auto worker = [&]() {
+		for (;;) {
+			std::size_t i = next.fetch_add(1, std::memory_order_relaxed);
+			if (i >= tasks.size()) return;
+			try {
+				fn(i);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(errorLock);
+				if (!error) error = std::current_exception();
+				next.store(tasks.size(), std::memory_order_relaxed);
+				return;
+			}
+		}
+	};
+
+	std::vector<std::thread> pool;
+	pool.reserve(threads - 1);
+	for (unsigned t = 1; t < threads; ++t) {
+		try {
+			pool.emplace_back(worker);
+		}
+		catch (std::system_error const&) {
+			break; // Out of threads: carry on with the ones we have
+		}
+	}
+	worker();
+	for (std::thread& t : pool) {
+		t.join();
+	}
+	if (error) std::rethrow_exception(error);
+}
+
+//-----------------------------------------------------------------------------
+// Refresh one task's subtree aggregates, children before parents
+//-----------------------------------------------------------------------------
+template<typename NODE>
+void CS280::AVLmapTasks<NODE>::refreshSubtree(std::size_t task) const {
+	if (!tasks[task].subtree) return; // Split nodes wait for refreshSpine()
+
+	NODE* root = tasks[task].node;
+	auto deepest = [](NODE* N) {
+		while (N->Left() || N->Right()) {
+			N = (N->Left()) ? N->Left() : N->Right();
+		}
+		return N;
+	};
+
+	// Post-order walk on parent pointers
+	NODE* N = deepest(root);
+	for (;;) {
+		N->updateAggregate();
+		if (N == root) break;
+		NODE* P = N->Parent();
+		N = (N == P->Left() && P->Right()) ? deepest(P->Right()) : P;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Refresh the split nodes' aggregates
+//-----------------------------------------------------------------------------
+template<typename NODE>
+void CS280::AVLmapTasks<NODE>::refreshSpine() const {
+	for (NODE* N : spine) {
+		N->updateAggregate();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Thread count (0 = hardware concurrency, at least 1)
+//-----------------------------------------------------------------------------
+template<typename NODE>
+unsigned CS280::AVLmapTasks<NODE>::threadCount(unsigned threads) {
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+	return (threads) ? threads : 1;
+}
+
+/*!****************************************************************************
+// Class AVLmapTasks Private Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// In-order split: subtrees at depth, single nodes above
+//-----------------------------------------------------------------------------
+template<typename NODE>
+void CS280::AVLmapTasks<NODE>::split(NODE* node, int depth) {
+	if (!node) return;
+	if (depth == 0) {
+		tasks.push_back(Task{ node, true });
+		return;
+	}
+	split(node->Left(), depth - 1);
+	tasks.push_back(Task{ node, false });
+	split(node->Right(), depth - 1);
+	spine.push_back(node);
+}
+
+/*!****************************************************************************
+// Parallel Walks
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Parallel For Each - fn(key, value&); aggregates are recomputed afterwards
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE, typename FN>
+void CS280::parallel_for_each(AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>& map, FN fn, unsigned threads) {
+	typedef typename AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node Node;
+	AVLmapTasks<Node> tasks(map.getRoot(), threads);
+
+	try {
+		tasks.run([&](std::size_t task) {
+			tasks.visit(task, [&](Node* N) { fn(N->Key(), N->Value()); });
+			if constexpr (AGGREGATE::enabled) {
+				tasks.refreshSubtree(task);
+			}
+		});
+	}
+	catch (...) {
+		if constexpr (AGGREGATE::enabled) {
+			// Some values may have changed in tasks that never got refreshed
+			for (std::size_t task = 0; task < tasks.size(); ++task) {
+				tasks.refreshSubtree(task);
+			}
+			tasks.refreshSpine();
+		}
+		throw;
+	}
+	if constexpr (AGGREGATE::enabled) {
+		tasks.refreshSpine();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Parallel Transform Reduce - per task partial results, joined in key order
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE, typename T, typename REDUCE, typename TRANSFORM>
+T CS280::parallel_transform_reduce(AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE> const& map, T init, REDUCE reduce, TRANSFORM transform, unsigned threads) {
+	typedef typename AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node Node;
+	AVLmapTasks<Node> tasks(map.getRoot(), threads);
+	std::vector<std::optional<T>> partials(tasks.size());
+
+	tasks.run([&](std::size_t task) {
+		std::optional<T>& partial = partials[task];
+		tasks.visit(task, [&](Node* N) {
+			VALUE_TYPE const& value = N->Value();
+			if (partial) {
+				partial = reduce(std::move(*partial), transform(N->Key(), value));
+			}
+			else {
+				partial.emplace(transform(N->Key(), value));
+			}
+		});
+	});
+
+	for (std::optional<T>& partial : partials) {
+		if (partial) init = reduce(std::move(init), std::move(*partial));
+	}
+	return init;
+}
+
+//-----------------------------------------------------------------------------
+// Parallel Collect If - per task matches, concatenated in key order
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE, typename PRED>
+std::vector<std::pair<KEY_TYPE, VALUE_TYPE>> CS280::parallel_collect_if(AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE> const& map, PRED pred, unsigned threads) {
+	typedef typename AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node Node;
+	typedef std::vector<std::pair<KEY_TYPE, VALUE_TYPE>> result_type;
+	AVLmapTasks<Node> tasks(map.getRoot(), threads);
+	std::vector<result_type> partials(tasks.size());
+
+	tasks.run([&](std::size_t task) {
+		result_type& partial = partials[task];
+		tasks.visit(task, [&](Node* N) {
+			VALUE_TYPE const& value = N->Value();
+			if (pred(N->Key(), value)) {
+				partial.emplace_back(N->Key(), value);
+			}
+		});
+	});
+
+	if (partials.size() == 1) return std::move(partials[0]);
+
+	std::size_t total = 0;
+	for (result_type const& partial : partials) {
+		total += partial.size();
+	}
+	result_type result;
+	result.reserve(total);
+	for (result_type& partial : partials) {
+		std::move(partial.begin(), partial.end(), std::back_inserter(result));
+	}
+	return result;
+}
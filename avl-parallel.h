@@ -0,0 +1,87 @@
+/*!*****************************************************************************
+*\file     avl-parallel.h
+*\author   Jalin A. Brown
+*\brief Description:
+	Parallel whole-map walks over an AVLmap.
+
+	The tree is cut a few levels below the root into an in-order list of
+	tasks: whole subtrees, plus the single nodes above them. A balanced tree
+	gives subtrees of nearly equal size, and about eight tasks per thread
+	even out the rest. Worker threads take the next task from a shared
+	counter; results are kept per task and joined in task order, so
+	ordered results come out in key order.
+
+	1) parallel_for_each - fn(key, value&) on every entry, in no set order.
+	   Subtree aggregates are recomputed afterwards.
+	2) parallel_transform_reduce - reduce(init, transform(key, value)...)
+	   in key order; reduce must be associative but need not commute.
+	3) parallel_collect_if - the (key, value) pairs matching pred, in key
+	   order.
+
+	The map must not be modified by other threads during a walk. threads = 0
+	uses std::thread::hardware_concurrency(). An exception from a callback
+	stops the walk and is rethrown to the caller.
+******************************************************************************/
+
+#ifndef AVLPARALLEL_H
+#define AVLPARALLEL_H
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl.h"
+#include <thread>    // std::thread
+#include <optional>  // std::optional
+#include <utility>   // std::pair
+
+namespace CS280 {
+		//-----------------------------------------------------------------------------
+		// AVLmapTasks class declarations - an in-order split of a tree into tasks
+		//-----------------------------------------------------------------------------
+		template<typename NODE>
+		class AVLmapTasks {
+		public:
+			AVLmapTasks(NODE* root, unsigned threads);
+
+			std::size_t size() const;
+			template<typename FN>
+			void visit(std::size_t task, FN fn) const; // fn(NODE*) in key order
+			template<typename FN>
+			void run(FN fn) const; // fn(task) for every task, spread over the threads
+
+			// Aggregate refresh after values changed: each task's subtree (in
+			// parallel), then the split nodes above them
+			void refreshSubtree(std::size_t task) const;
+			void refreshSpine() const;
+
+			static unsigned threadCount(unsigned threads); // 0 = hardware concurrency
+
+		private:
+			struct Task {
+				NODE* node;
+				bool  subtree; // the whole subtree, or just the node
+			};
+
+			void split(NODE* node, int depth);
+
+			std::vector<Task> tasks;  // in key order
+			std::vector<NODE*> spine; // split nodes, children before parents
+			unsigned threads;
+		};
+
+		//-----------------------------------------------------------------------------
+		// Parallel walks
+		//-----------------------------------------------------------------------------
+		template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE, typename FN>
+		void parallel_for_each(AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>& map, FN fn, unsigned threads = 0);
+
+		template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE, typename T, typename REDUCE, typename TRANSFORM>
+		T parallel_transform_reduce(AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE> const& map, T init, REDUCE reduce, TRANSFORM transform, unsigned threads = 0);
+
+		template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE, typename PRED>
+		std::vector<std::pair<KEY_TYPE, VALUE_TYPE>> parallel_collect_if(AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE> const& map, PRED pred, unsigned threads = 0);
+}
+
+#include "avl-parallel.cpp"
+#endif
@@ -0,0 +1,423 @@
+/*!*****************************************************************************
+*\file     avl-sharded.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	Sharded AVLmap for multi-threaded use.
+
+	Every operation takes layoutLock shared and then the mutex of the single
+	shard it touches. Layout changes take layoutLock exclusively, so shard
+	boundaries never move under a running operation.
+
+	Entries change shards through extract() / insert(node_type&&): the node
+	itself is relinked, and a failed insert puts it back where it came from,
+	so an exception never loses an entry. bounds[i] is updated after every
+	move and always splits shard i from shard i + 1.
+******************************************************************************/
+
+#include "avl-sharded.h"
+#include <algorithm> // std::upper_bound, std::rotate, std::max
+#include <queue>		 // std::priority_queue
+#include <limits>		 // std::numeric_limits
+
+/*!****************************************************************************
+// Class ShardedAVLmap Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// CTOR
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::ShardedAVLmap(std::size_t shardCount, ShardPartition partition, double skewLimit)
+	: partition(partition), skewLimit(skewLimit) {
+	if (shardCount == 0) shardCount = 1;
+	for (std::size_t i = 0; i < shardCount; ++i) {
+		shards.push_back(std::unique_ptr<Shard>(new Shard));
+	}
+	bounds.reserve(shardCount - 1); // Layout changes never reallocate
+}
+
+//-----------------------------------------------------------------------------
+// Insert (overwrites like AVLmap::insert)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+void CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::insert(KEY_TYPE const& key, VALUE_TYPE const& value) {
+	std::size_t shard;
+	{
+		std::shared_lock<std::shared_mutex> layout(layoutLock);
+		shard = shardOf(key);
+		std::lock_guard<std::mutex> guard(shards[shard]->lock);
+		std::size_t before = shards[shard]->map.size();
+		shards[shard]->map.insert(key, value);
+		if (shards[shard]->map.size() != before) ++count;
+	}
+	checkSkew(shard);
+}
+
+//-----------------------------------------------------------------------------
+// Find - copies the value out while the shard is locked
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+bool CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::find(KEY_TYPE const& key, VALUE_TYPE& value) const {
+	std::shared_lock<std::shared_mutex> layout(layoutLock);
+	Shard& S = *shards[shardOf(key)];
+	std::lock_guard<std::mutex> guard(S.lock);
+	typename map_type::iterator it = S.map.find(key);
+	if (it == S.map.end()) return false;
+	value = it->Value();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Contains
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+bool CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::contains(KEY_TYPE const& key) const {
+	std::shared_lock<std::shared_mutex> layout(layoutLock);
+	Shard& S = *shards[shardOf(key)];
+	std::lock_guard<std::mutex> guard(S.lock);
+	return S.map.find(key) != S.map.end();
+}
+
+//-----------------------------------------------------------------------------
+// Erase - returns true if the key was present
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+bool CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::erase(KEY_TYPE const& key) {
+	std::shared_lock<std::shared_mutex> layout(layoutLock);
+	Shard& S = *shards[shardOf(key)];
+	std::lock_guard<std::mutex> guard(S.lock);
+	typename map_type::iterator it = S.map.find(key);
+	if (it == S.map.end()) return false;
+	S.map.erase(it);
+	--count;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Update - runs fn on the (possibly default constructed) value under the lock
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+template<typename FN>
+void CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::update(KEY_TYPE const& key, FN fn) {
+	std::size_t shard;
+	{
+		std::shared_lock<std::shared_mutex> layout(layoutLock);
+		shard = shardOf(key);
+		std::lock_guard<std::mutex> guard(shards[shard]->lock);
+		std::size_t before = shards[shard]->map.size();
+		fn(shards[shard]->map[key]);
+		if (shards[shard]->map.size() != before) ++count;
+	}
+	checkSkew(shard);
+}
+
+//-----------------------------------------------------------------------------
+// Size
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+std::size_t CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::size() const {
+	return count.load();
+}
+
+//-----------------------------------------------------------------------------
+// Shard Count
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+std::size_t CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::shardCount() const {
+	return shards.size();
+}
+
+//-----------------------------------------------------------------------------
+// Shard Sizes (each read under its shard lock)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+std::vector<std::size_t> CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::shardSizes() const {
+	std::shared_lock<std::shared_mutex> layout(layoutLock);
+	std::vector<std::size_t> sizes;
+	for (std::size_t i = 0; i < shards.size(); ++i) {
+		std::lock_guard<std::mutex> guard(shards[i]->lock);
+		sizes.push_back(shards[i]->map.size());
+	}
+	return sizes;
+}
+
+//-----------------------------------------------------------------------------
+// Ordered For Each - shards are locked in index order for the whole walk
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+template<typename FN>
+void CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::for_each(FN fn) const {
+	typedef typename map_type::Node Node;
+
+	std::shared_lock<std::shared_mutex> layout(layoutLock);
+	std::vector<std::unique_lock<std::mutex>> guards;
+	for (std::size_t i = 0; i < shards.size(); ++i) {
+		guards.push_back(std::unique_lock<std::mutex>(shards[i]->lock));
+	}
+
+	// Range shards are already in key order: walk them one after another
+	if (partition == ShardPartition::Range) {
+		for (std::size_t i = 0; i < shards.size(); ++i) {
+			for (typename map_type::iterator it = shards[i]->map.begin(); it != shards[i]->map.end(); ++it) {
+				fn(it->Key(), static_cast<VALUE_TYPE const&>(it->Value()));
+			}
+		}
+		return;
+	}
+
+	// Hash shards interleave: k-way merge on the smallest current key
+	auto greater = [](Node* a, Node* b) { return b->Key() < a->Key(); };
+	std::priority_queue<Node*, std::vector<Node*>, decltype(greater)> heads(greater);
+	for (std::size_t i = 0; i < shards.size(); ++i) {
+		if (Node* N = shards[i]->map.begin().getnode()) heads.push(N);
+	}
+	while (!heads.empty()) {
+		Node* N = heads.top();
+		heads.pop();
+		fn(N->Key(), static_cast<VALUE_TYPE const&>(N->Value()));
+		if (Node* next = N->increment()) heads.push(next);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Rebalance - put every spare to use, then even out the range shards: one
+// pass pushes surpluses up, a second pulls deficits down (no-op for Hash)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+void CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::rebalance() {
+	if (partition != ShardPartition::Range) return;
+
+	std::unique_lock<std::shared_mutex> layout(layoutLock);
+	while (used < shards.size()) {
+		std::size_t largest = 0;
+		for (std::size_t i = 1; i < used; ++i) {
+			if (shardSize(i) > shardSize(largest)) largest = i;
+		}
+		if (shardSize(largest) < 2) break;
+		splitShard(largest);
+	}
+
+	std::size_t total = 0;
+	for (std::size_t i = 0; i < used; ++i) {
+		total += shardSize(i);
+	}
+
+	// prefix = entries in shards 0..i, target (i + 1) * total / used
+	std::size_t prefix = 0;
+	for (std::size_t i = 0; i + 1 < used; ++i) {
+		prefix += shardSize(i);
+		std::size_t target = (i + 1) * total / used;
+		if (prefix > target) prefix -= moveAcross(i, prefix - target, true);
+	}
+	prefix = total - shardSize(used - 1);
+	for (std::size_t i = used - 1; i-- > 0; ) {
+		std::size_t target = (i + 1) * total / used;
+		if (prefix < target) prefix += moveAcross(i, target - prefix, false);
+		prefix -= shardSize(i);
+	}
+}
+
+/*!****************************************************************************
+// Class ShardedAVLmap Private Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Shard index for a key
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+std::size_t CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::shardOf(KEY_TYPE const& key) const {
+	if (partition == ShardPartition::Hash) {
+		return hasher(key) % shards.size();
+	}
+	return static_cast<std::size_t>(std::upper_bound(bounds.begin(), bounds.end(), key) - bounds.begin());
+}
+
+//-----------------------------------------------------------------------------
+// Fix a range shard that outgrew skewBound(): split it into a spare, or merge
+// the smallest neighbouring pair to free one, or shift half the difference
+// to its smaller neighbour. Checks are spaced max(minShardSize, size / 4N)
+// inserts apart; only one thread rebalances, the others carry on.
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+void CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::checkSkew(std::size_t shard) {
+	if (partition != ShardPartition::Range || shards.size() < 2) return;
+
+	std::size_t total = count.load();
+	if (total < nextCheck.load(std::memory_order_relaxed)) return;
+	nextCheck.store(total + std::max(minShardSize, total / (4 * shards.size())), std::memory_order_relaxed);
+
+	{
+		// `used` changes under the exclusive lock, so read the bound in here too
+		std::shared_lock<std::shared_mutex> layout(layoutLock);
+		std::lock_guard<std::mutex> guard(shards[shard]->lock);
+		if (shards[shard]->map.size() <= skewBound(total)) return;
+	}
+
+	bool expected = false;
+	if (!rebalancing.compare_exchange_strong(expected, true)) return;
+	try {
+		std::unique_lock<std::shared_mutex> layout(layoutLock);
+
+		// Shards may have moved since the check: work on the largest
+		std::size_t largest = 0;
+		for (std::size_t i = 1; i < used; ++i) {
+			if (shardSize(i) > shardSize(largest)) largest = i;
+		}
+		std::size_t limit = skewBound(count.load());
+		if (shardSize(largest) > limit) {
+			if (used < shards.size()) {
+				splitShard(largest);
+			}
+			else {
+				std::size_t pair = std::numeric_limits<std::size_t>::max();
+				std::size_t pairSize = std::numeric_limits<std::size_t>::max();
+				for (std::size_t i = 0; i + 1 < used; ++i) {
+					if (i == largest || i + 1 == largest) continue;
+					std::size_t sum = shardSize(i) + shardSize(i + 1);
+					if (sum < pairSize) {
+						pair = i;
+						pairSize = sum;
+					}
+				}
+				if (pairSize <= limit) {
+					mergeShards(pair);
+					if (largest > pair) --largest;
+					splitShard(largest);
+				}
+				else {
+					bool up = largest + 1 < used && (largest == 0 || shardSize(largest + 1) < shardSize(largest - 1));
+					std::size_t neighbour = (up) ? largest + 1 : largest - 1;
+					std::size_t half = (shardSize(largest) - shardSize(neighbour)) / 2;
+					moveAcross((up) ? largest : largest - 1, half, up);
+				}
+			}
+		}
+	}
+	catch (...) {
+		rebalancing.store(false);
+		throw;
+	}
+	rebalancing.store(false);
+}
+
+//-----------------------------------------------------------------------------
+// Largest size a range shard may reach before it is rebalanced: the average
+// while spares are left, skewLimit x the average after (caller holds
+// layoutLock, shared or exclusive)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+std::size_t CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::skewBound(std::size_t total) const {
+	double average = static_cast<double>(total) / static_cast<double>(shards.size());
+	double limit = (used < shards.size()) ? average : skewLimit * average;
+	return std::max(minShardSize, static_cast<std::size_t>(limit));
+}
+
+//-----------------------------------------------------------------------------
+// Move up to n entries across the boundary between shard boundary and the
+// next: up takes the largest keys of the lower shard, down the smallest of
+// the upper one (which keeps at least one key, its first key being the
+// bound)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+std::size_t CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::moveAcross(std::size_t boundary, std::size_t n, bool up) {
+	map_type& lower = shards[boundary]->map;
+	map_type& upper = shards[boundary + 1]->map;
+	std::size_t moved = 0;
+	for (; moved < n; ++moved) {
+		if (up) {
+			if (lower.size() == 0) break;
+			typename map_type::iterator last(lower.getRoot()->last());
+			KEY_TYPE bound = last->Key();
+			moveEntry(lower, upper, last);
+			bounds[boundary] = std::move(bound);
+		}
+		else {
+			if (upper.size() < 2) break;
+			moveEntry(upper, lower, upper.begin());
+			bounds[boundary] = upper.begin()->Key();
+		}
+	}
+	return moved;
+}
+
+//-----------------------------------------------------------------------------
+// Relink one entry into another shard; if that throws it goes back. Shards
+// carry no budget, so only the comparator can throw on the way back, and an
+// entry whose key cannot be compared twice in a row is lost with the handle
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+void CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::moveEntry(map_type& from, map_type& to, typename map_type::iterator it) {
+	typename map_type::node_type handle = from.extract(it);
+	try {
+		to.insert(std::move(handle));
+	}
+	catch (...) {
+		from.insert(std::move(handle)); // Its own charge was just released
+		throw;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Split a range shard: a spare takes the position after it, with an empty
+// key range, and then its top half
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+void CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::splitShard(std::size_t shard) {
+	std::size_t half = shardSize(shard) / 2;
+	if (shard + 1 < used) {
+		KEY_TYPE bound = bounds[shard]; // [bound, bound) is empty
+		bounds.insert(bounds.begin() + shard, std::move(bound));
+		std::rotate(shards.begin() + shard + 1, shards.begin() + used, shards.begin() + used + 1);
+		++used;
+		moveAcross(shard, half, true);
+	}
+	else {
+		// The last shard has no upper bound to copy: the spare (already next)
+		// takes the largest key first, which becomes the bound
+		map_type& from = shards[shard]->map;
+		typename map_type::iterator last(from.getRoot()->last());
+		KEY_TYPE bound = last->Key();
+		moveEntry(from, shards[shard + 1]->map, last);
+		bounds.push_back(std::move(bound));
+		++used;
+		moveAcross(shard, half - 1, true);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Merge two neighbouring range shards: the smaller one moves into the other,
+// which takes over its key range
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+void CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::mergeShards(std::size_t left) {
+	std::size_t right = left + 1;
+	if (shardSize(left) <= shardSize(right)) {
+		moveAcross(left, shardSize(left), true);
+		bounds.erase(bounds.begin() + left); // right now starts where left did
+		retireShard(left);
+	}
+	else {
+		moveAcross(left, shardSize(right), false); // Stops at the last key, the bound
+		map_type& from = shards[right]->map;
+		if (from.size()) moveEntry(from, shards[left]->map, from.begin());
+		bounds.erase(bounds.begin() + left); // left now ends where right did
+		retireShard(right);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Move an emptied shard (its bound already dropped) behind the ones in use
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+void CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::retireShard(std::size_t shard) {
+	std::rotate(shards.begin() + shard, shards.begin() + shard + 1, shards.begin() + used);
+	--used;
+}
+
+//-----------------------------------------------------------------------------
+// Shard size (caller holds layoutLock exclusively)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH>
+std::size_t CS280::ShardedAVLmap<KEY_TYPE, VALUE_TYPE, HASH>::shardSize(std::size_t shard) const {
+	return shards[shard]->map.size();
+}
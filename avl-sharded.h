@@ -0,0 +1,116 @@
+/*!*****************************************************************************
+*\file     avl-sharded.h
+*\author   Jalin A. Brown
+*\brief Description:
+	Sharded AVLmap for multi-threaded use.
+
+	Keys are partitioned over N AVLmap shards, each behind its own mutex, so
+	threads working on different shards do not contend.
+
+	1) Range partitioning keeps shards in key order. Shards start out as
+	   spares; while any are left, a shard past the average shard size (and
+	   past minShardSize) moves its top half into one. After that a shard
+	   past skewLimit times the average splits into a spare freed by merging
+	   the two smallest neighbours or, when no merge fits, shifts entries to
+	   its smaller neighbour. Only entries crossing a boundary move, as whole
+	   nodes (no copies, no allocation), and the skew is checked at most
+	   every max(minShardSize, size / 4N) inserts.
+	2) Hash partitioning spreads keys evenly and never needs rebalancing.
+	3) Ordered iteration (for_each) merges the shards: concatenation for
+	   range shards, a k-way merge for hash shards.
+******************************************************************************/
+
+#ifndef AVLSHARDED_H
+#define AVLSHARDED_H
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl.h"
+#include <mutex>				// std::mutex, std::lock_guard
+#include <shared_mutex> // std::shared_mutex, std::shared_lock
+#include <atomic>				// std::atomic
+#include <memory>				// std::unique_ptr
+#include <functional>		// std::hash
+
+namespace CS280 {
+		//-----------------------------------------------------------------------------
+		// ShardPartition - how keys are assigned to shards
+		//-----------------------------------------------------------------------------
+		enum class ShardPartition {
+			Range, // contiguous key ranges, boundaries move on rebalance
+			Hash   // HASH(key) % shard count
+		};
+
+		//-----------------------------------------------------------------------------
+		// ShardedAVLmap class declarations
+		//-----------------------------------------------------------------------------
+		template<typename KEY_TYPE, typename VALUE_TYPE, typename HASH = std::hash<KEY_TYPE>>
+		class ShardedAVLmap {
+		public:
+			typedef AVLmap<KEY_TYPE, VALUE_TYPE> map_type;
+
+			// BIG FOUR
+			explicit ShardedAVLmap(std::size_t shardCount, ShardPartition partition = ShardPartition::Range, double skewLimit = 2.0);
+			ShardedAVLmap(const ShardedAVLmap&)            = delete;
+			ShardedAVLmap& operator=(const ShardedAVLmap&) = delete;
+			~ShardedAVLmap() = default;
+
+			// Single key operations (each locks one shard)
+			void insert(KEY_TYPE const& key, VALUE_TYPE const& value);
+			bool find(KEY_TYPE const& key, VALUE_TYPE& value) const; // copies the value out
+			bool contains(KEY_TYPE const& key) const;
+			bool erase(KEY_TYPE const& key);
+			template<typename FN>
+			void update(KEY_TYPE const& key, FN fn); // fn(VALUE_TYPE&) on operator[] of the key
+
+			// Getters
+			std::size_t size() const;
+			std::size_t shardCount() const;
+			std::vector<std::size_t> shardSizes() const;
+
+			// Whole map operations (lock every shard)
+			template<typename FN>
+			void for_each(FN fn) const; // fn(key, value) in ascending key order
+			void rebalance();           // even out every range shard now
+
+		private:
+			//-----------------------------------------------------------------------------
+			// Shard - one AVLmap and the mutex guarding it
+			//-----------------------------------------------------------------------------
+			struct Shard {
+				mutable std::mutex lock;
+				map_type           map;
+			};
+
+			std::size_t shardOf(KEY_TYPE const& key) const; // caller holds layoutLock
+			void checkSkew(std::size_t shard);
+
+			std::size_t skewBound(std::size_t total) const; // caller holds layoutLock, shared is enough
+
+			// Range layout changes (caller holds layoutLock exclusively)
+			std::size_t moveAcross(std::size_t boundary, std::size_t n, bool up); // returns the count moved
+			void moveEntry(map_type& from, map_type& to, typename map_type::iterator it);
+			void splitShard(std::size_t shard);  // top half into a spare shard
+			void mergeShards(std::size_t left);  // left and left + 1 into one, freeing a spare
+			void retireShard(std::size_t shard); // an empty shard with no key range becomes a spare
+			std::size_t shardSize(std::size_t shard) const;
+
+			std::vector<std::unique_ptr<Shard>> shards;
+			std::vector<KEY_TYPE> bounds;            // Range: shard i holds keys < bounds[i]
+			std::size_t used = 1;                    // Range: shards in use, the rest are empty spares
+			mutable std::shared_mutex layoutLock;    // shared by operations, exclusive for rebalance
+			std::atomic<std::size_t> count{0};
+			std::atomic<std::size_t> nextCheck{0};   // no skew check before count reaches this
+			std::atomic<bool> rebalancing{false};
+			ShardPartition partition;
+			double skewLimit;
+			HASH hasher;
+
+			static constexpr std::size_t minShardSize = 64; // shards are not split below this many keys
+	};
+}
+
+#include "avl-sharded.cpp"
+#endif
@@ -0,0 +1,287 @@
+/*!*****************************************************************************
+*\file     avl-static.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	Fixed capacity AVL map that can be built at compile time.
+
+	Insert is the recursive form of AVLmap insert: descend, link the new
+	node, then rebalance each node on the way back up. Rotations return
+	the new subtree root index instead of rewiring parent pointers.
+******************************************************************************/
+
+#include "avl-static.h"
+
+/*!****************************************************************************
+// Class StaticAVLmap Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// CTOR
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::StaticAVLmap() : nodes{}, root(npos), count(0) {
+}
+
+//-----------------------------------------------------------------------------
+// CTOR - from a list of entries; more distinct keys than CAPACITY throw,
+// which makes an overfull constexpr table a compile error
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::StaticAVLmap(std::initializer_list<std::pair<KEY_TYPE, VALUE_TYPE>> entries)
+	: nodes{}, root(npos), count(0) {
+	for (std::pair<KEY_TYPE, VALUE_TYPE> const& entry : entries) {
+		if (!insert(entry.first, entry.second)) {
+			throw std::length_error("StaticAVLmap: more entries than CAPACITY");
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Insert
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr bool CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::insert(KEY_TYPE const& key, VALUE_TYPE const& value) {
+	bool fits = true;
+	root = insertAt(root, key, value, fits);
+	return fits;
+}
+
+//-----------------------------------------------------------------------------
+// Find
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr VALUE_TYPE const* CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::find(KEY_TYPE const& key) const {
+	index_type n = root;
+	while (n != npos) {
+		if (key < nodes[n].key) {
+			n = nodes[n].left;
+		}
+		else if (nodes[n].key < key) {
+			n = nodes[n].right;
+		}
+		else {
+			return &nodes[n].value;
+		}
+	}
+	return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Contains
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr bool CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::contains(KEY_TYPE const& key) const {
+	return find(key) != nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Ordered For Each
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+template<typename FN>
+constexpr void CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::for_each(FN fn) const {
+	walk(root, fn);
+}
+
+//-----------------------------------------------------------------------------
+// Size
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr unsigned int CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::size() const {
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// Capacity
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr unsigned int CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::capacity() const {
+	return static_cast<unsigned int>(CAPACITY);
+}
+
+//-----------------------------------------------------------------------------
+// Empty
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr bool CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::empty() const {
+	return count == 0;
+}
+
+//-----------------------------------------------------------------------------
+// Height (-1 when empty, like AVLmap)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr int CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::getHeight() const {
+	return heightOf(root);
+}
+
+//-----------------------------------------------------------------------------
+// Root index (npos when empty)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr typename CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::index_type CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::getRoot() const {
+	return root;
+}
+
+//-----------------------------------------------------------------------------
+// Node by index, for walks outside StaticAVLmap
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr typename CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::Node const& CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::node(index_type i) const {
+	return nodes[i];
+}
+
+//-----------------------------------------------------------------------------
+// Validate
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr bool CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::validate() const {
+	return validateAt(root, nullptr, nullptr);
+}
+
+/*!****************************************************************************
+// Class StaticAVLmap Private Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Height of a possibly empty subtree
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr int CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::heightOf(index_type n) const {
+	return (n == npos) ? -1 : nodes[n].height;
+}
+
+//-----------------------------------------------------------------------------
+// Update Height
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr void CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::updateHeight(index_type n) {
+	int l = heightOf(nodes[n].left);
+	int r = heightOf(nodes[n].right);
+	nodes[n].height = 1 + ((l > r) ? l : r);
+}
+
+//-----------------------------------------------------------------------------
+// Left Rotate - returns the new subtree root
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr typename CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::index_type CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::leftRotate(index_type n) {
+	index_type r = nodes[n].right;
+	nodes[n].right = nodes[r].left;
+	nodes[r].left = n;
+	updateHeight(n);
+	updateHeight(r);
+	return r;
+}
+
+//-----------------------------------------------------------------------------
+// Right Rotate - returns the new subtree root
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr typename CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::index_type CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::rightRotate(index_type n) {
+	index_type l = nodes[n].left;
+	nodes[n].left = nodes[l].right;
+	nodes[l].right = n;
+	updateHeight(n);
+	updateHeight(l);
+	return l;
+}
+
+//-----------------------------------------------------------------------------
+// Restore balance at n (single or double rotation), returns the subtree root
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr typename CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::index_type CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::rebalance(index_type n) {
+	updateHeight(n);
+	int balance = heightOf(nodes[n].left) - heightOf(nodes[n].right);
+
+	if (balance > 1) {
+		index_type l = nodes[n].left;
+		if (heightOf(nodes[l].left) < heightOf(nodes[l].right)) {
+			nodes[n].left = leftRotate(l); // Left-Right
+		}
+		return rightRotate(n);
+	}
+	if (balance < -1) {
+		index_type r = nodes[n].right;
+		if (heightOf(nodes[r].right) < heightOf(nodes[r].left)) {
+			nodes[n].right = rightRotate(r); // Right-Left
+		}
+		return leftRotate(n);
+	}
+	return n;
+}
+
+//-----------------------------------------------------------------------------
+// Insert below n, returns the (possibly rotated) subtree root
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr typename CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::index_type CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::insertAt(index_type n, KEY_TYPE const& key, VALUE_TYPE const& value, bool& fits) {
+	if (n == npos) {
+		if (count == CAPACITY) {
+			fits = false;
+			return npos;
+		}
+		Node& fresh = nodes[count];
+		fresh.key = key;
+		fresh.value = value;
+		return count++;
+	}
+
+	if (key < nodes[n].key) {
+		nodes[n].left = insertAt(nodes[n].left, key, value, fits);
+	}
+	else if (nodes[n].key < key) {
+		nodes[n].right = insertAt(nodes[n].right, key, value, fits);
+	}
+	else {
+		nodes[n].value = value;
+		return n;
+	}
+	return fits ? rebalance(n) : n;
+}
+
+//-----------------------------------------------------------------------------
+// In-order walk
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+template<typename FN>
+constexpr void CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::walk(index_type n, FN& fn) const {
+	if (n == npos) return;
+	walk(nodes[n].left, fn);
+	fn(nodes[n].key, nodes[n].value);
+	walk(nodes[n].right, fn);
+}
+
+//-----------------------------------------------------------------------------
+// Keys within (lo, hi), stored heights correct, balance in [-1, 1]
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+constexpr bool CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, CAPACITY>::validateAt(index_type n, KEY_TYPE const* lo, KEY_TYPE const* hi) const {
+	if (n == npos) return true;
+	Node const& N = nodes[n];
+	if (lo && !(*lo < N.key)) return false;
+	if (hi && !(N.key < *hi)) return false;
+	if (!validateAt(N.left, lo, &N.key) || !validateAt(N.right, &N.key, hi)) return false;
+
+	int l = heightOf(N.left);
+	int r = heightOf(N.right);
+	int balance = l - r;
+	return N.height == 1 + ((l > r) ? l : r) && balance >= -1 && balance <= 1;
+}
+
+/*!****************************************************************************
+// Helpers
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Make a StaticAVLmap sized to its initializer
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t N>
+constexpr CS280::StaticAVLmap<KEY_TYPE, VALUE_TYPE, N> CS280::makeStaticAVLmap(std::pair<KEY_TYPE, VALUE_TYPE> const (&entries)[N]) {
+	StaticAVLmap<KEY_TYPE, VALUE_TYPE, N> table;
+	for (std::size_t i = 0; i < N; ++i) {
+		table.insert(entries[i].first, entries[i].second);
+	}
+	return table;
+}
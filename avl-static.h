@@ -0,0 +1,117 @@
+/*!*****************************************************************************
+*\file     avl-static.h
+*\author   Jalin A. Brown
+*\brief Description:
+	Fixed capacity AVL map that can be built at compile time.
+
+	Same balancing as AVLmap (height per node, single / double rotations
+	after each insert), but nodes live in an array inside the object and
+	link to each other by index, so nothing is allocated and every method
+	is constexpr. A table declared
+
+		constexpr StaticAVLmap<std::string_view, int, 3> opcodes{
+			{ { "add", 1 }, { "sub", 2 }, { "mul", 3 } } };
+
+	is balanced by the compiler, lands in read-only data and costs nothing
+	at startup; a list with more keys than CAPACITY does not compile.
+	KEY_TYPE and VALUE_TYPE must be literal, default constructible types;
+	there is no erase (tables are built once). tests/static-table.cpp holds
+	the compile time checks.
+******************************************************************************/
+
+#ifndef AVLSTATIC_H
+#define AVLSTATIC_H
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include <cstddef>					// std::size_t
+#include <utility>					// std::pair
+#include <initializer_list> // std::initializer_list
+#include <stdexcept>				// std::length_error
+
+namespace CS280 {
+		//-----------------------------------------------------------------------------
+		// StaticAVLmap class declarations
+		//-----------------------------------------------------------------------------
+		template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t CAPACITY>
+		class StaticAVLmap {
+			static_assert(CAPACITY > 0, "StaticAVLmap needs room for at least one entry");
+
+		public:
+			typedef unsigned int index_type;
+			static constexpr index_type npos = static_cast<index_type>(-1); // no child
+
+			//-----------------------------------------------------------------------------
+			// Node - an array slot; children are indices into the same array
+			//-----------------------------------------------------------------------------
+			class Node {
+				public:
+					// Getters
+					constexpr KEY_TYPE const&   Key() const   { return key; }
+					constexpr VALUE_TYPE const& Value() const { return value; }
+					constexpr index_type Left() const  { return left; }
+					constexpr index_type Right() const { return right; }
+
+				private:
+					KEY_TYPE   key    = KEY_TYPE();
+					VALUE_TYPE value  = VALUE_TYPE();
+					index_type left   = npos;
+					index_type right  = npos;
+					int        height = 0;
+
+					friend class StaticAVLmap;
+			};
+
+			// Construction (entries in any order; a repeated key keeps the last value,
+			// more distinct keys than CAPACITY throw std::length_error)
+			constexpr StaticAVLmap();
+			constexpr StaticAVLmap(std::initializer_list<std::pair<KEY_TYPE, VALUE_TYPE>> entries);
+
+			// Insert or overwrite; false when a new key does not fit
+			constexpr bool insert(KEY_TYPE const& key, VALUE_TYPE const& value);
+
+			// Lookup
+			constexpr VALUE_TYPE const* find(KEY_TYPE const& key) const; // nullptr if missing
+			constexpr bool contains(KEY_TYPE const& key) const;
+
+			// In-order walk, fn(key, value)
+			template<typename FN>
+			constexpr void for_each(FN fn) const;
+
+			// Getters
+			constexpr unsigned int size() const;
+			constexpr unsigned int capacity() const;
+			constexpr bool empty() const;
+			constexpr int getHeight() const;
+			constexpr index_type getRoot() const;
+			constexpr Node const& node(index_type i) const;
+
+			// Order and AVL balance hold everywhere (usable in static_assert)
+			constexpr bool validate() const;
+
+		private:
+			constexpr int heightOf(index_type n) const;
+			constexpr void updateHeight(index_type n);
+			constexpr index_type leftRotate(index_type n);
+			constexpr index_type rightRotate(index_type n);
+			constexpr index_type rebalance(index_type n);
+			constexpr index_type insertAt(index_type n, KEY_TYPE const& key, VALUE_TYPE const& value, bool& fits);
+			template<typename FN>
+			constexpr void walk(index_type n, FN& fn) const;
+			constexpr bool validateAt(index_type n, KEY_TYPE const* lo, KEY_TYPE const* hi) const;
+
+			Node nodes[CAPACITY];
+			index_type root;
+			unsigned int count;
+	};
+
+	// Build a table sized to its initializer:
+	//   constexpr auto t = makeStaticAVLmap<std::string_view, int>({ { "a", 1 }, { "b", 2 } });
+	template<typename KEY_TYPE, typename VALUE_TYPE, std::size_t N>
+	constexpr StaticAVLmap<KEY_TYPE, VALUE_TYPE, N> makeStaticAVLmap(std::pair<KEY_TYPE, VALUE_TYPE> const (&entries)[N]);
+}
+
+#include "avl-static.cpp"
+#endif
@@ -0,0 +1,364 @@
+/*!*****************************************************************************
+*\file     avl-string.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	String keyed AVLmap with compact keys and prefix skipping lookups.
+
+	Bytes are compared as unsigned char, the order std::string uses, so a
+	StringAVLmap iterates in the same order as AVLmap<std::string, V>.
+******************************************************************************/
+
+#include "avl-string.h"
+#include <cstring> // std::memcpy, std::memcmp
+
+/*!****************************************************************************
+// Class CompactString Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// CTOR
+//-----------------------------------------------------------------------------
+inline CS280::CompactString::CompactString(char const* data, std::uint32_t length) : length(length) {
+	if (length <= inlineBytes) {
+		std::memcpy(bytes, data, length);
+	}
+	else {
+		std::memcpy(bytes, data, 4);
+		std::memcpy(bytes + 4, &data, sizeof(data));
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Size
+//-----------------------------------------------------------------------------
+inline std::size_t CS280::CompactString::size() const {
+	return length;
+}
+
+//-----------------------------------------------------------------------------
+// Data (not null terminated)
+//-----------------------------------------------------------------------------
+inline char const* CS280::CompactString::data() const {
+	if (length <= inlineBytes) {
+		return bytes;
+	}
+	char const* p;
+	std::memcpy(&p, bytes + 4, sizeof(p));
+	return p;
+}
+
+//-----------------------------------------------------------------------------
+// View
+//-----------------------------------------------------------------------------
+inline std::string_view CS280::CompactString::view() const {
+	return std::string_view(data(), length);
+}
+
+//-----------------------------------------------------------------------------
+// Is the whole string inline
+//-----------------------------------------------------------------------------
+inline bool CS280::CompactString::isInline() const {
+	return length <= inlineBytes;
+}
+
+/*!****************************************************************************
+// CompactString Comparison Operators - the inline prefix settles most
+// comparisons without touching the arena
+******************************************************************************/
+
+inline bool CS280::operator<(CompactString const& a, CompactString const& b) {
+	std::size_t n = (a.size() < b.size()) ? a.size() : b.size();
+	std::size_t head = (n < 4) ? n : 4;
+	int c = std::memcmp(a.bytes, b.bytes, head);
+	if (c == 0 && n > head) {
+		c = std::memcmp(a.data() + head, b.data() + head, n - head);
+	}
+	return (c != 0) ? c < 0 : a.size() < b.size();
+}
+
+inline bool CS280::operator>(CompactString const& a, CompactString const& b) {
+	return b < a;
+}
+
+inline bool CS280::operator==(CompactString const& a, CompactString const& b) {
+	return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+/*!****************************************************************************
+// Class StringAVLmap Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Move CTOR - takes the arena with the keys; other is left empty
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::StringAVLmap(StringAVLmap&& other) noexcept
+	: entries(std::move(other.entries)), blocks(std::move(other.blocks)), blockSizes(std::move(other.blockSizes)),
+	  cursor(other.cursor), left(other.left), liveBytes(other.liveBytes), deadBytes(other.deadBytes) {
+	other.blocks.clear();
+	other.blockSizes.clear();
+	other.cursor    = nullptr;
+	other.left      = 0;
+	other.liveBytes = 0;
+	other.deadBytes = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Move Assignment - the old keys go before the blocks they point into
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>& CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::operator=(StringAVLmap&& other) noexcept {
+	if (this != &other) {
+		entries    = std::move(other.entries);
+		blocks     = std::move(other.blocks);
+		blockSizes = std::move(other.blockSizes);
+		cursor     = other.cursor;
+		left       = other.left;
+		liveBytes  = other.liveBytes;
+		deadBytes  = other.deadBytes;
+
+		other.blocks.clear();
+		other.blockSizes.clear();
+		other.cursor    = nullptr;
+		other.left      = 0;
+		other.liveBytes = 0;
+		other.deadBytes = 0;
+	}
+	return *this;
+}
+
+//-----------------------------------------------------------------------------
+// Insert - overwrites like AVLmap::insert
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+void CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::insert(std::string_view key, VALUE_TYPE const& value) {
+	Node* P = nullptr;
+	if (Node* N = search(key, P)) {
+		N->setValue(value);
+		return;
+	}
+	entries.insert(store(key), value);
+}
+
+//-----------------------------------------------------------------------------
+// Operator[]
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+VALUE_TYPE& CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::operator[](std::string_view key) {
+	Node* P = nullptr;
+	Node* N = search(key, P);
+	if (!N) {
+		return entries[store(key)];
+	}
+	if constexpr (AGGREGATE::enabled) {
+		return entries[N->Key()]; // Lets AVLmap queue the aggregate refresh
+	}
+	else {
+		return N->Value();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Erase - returns true if the key was present
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+bool CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::erase(std::string_view key) {
+	Node* P = nullptr;
+	Node* N = search(key, P);
+	if (!N) return false;
+
+	if (!N->Key().isInline()) {
+		liveBytes -= key.size();
+		deadBytes += key.size();
+	}
+	entries.erase(typename map_type::iterator(N));
+
+	if (deadBytes > liveBytes && deadBytes > blockBytes) {
+		repack();
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Find
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+VALUE_TYPE* CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::find(std::string_view key) {
+	Node* P = nullptr;
+	Node* N = search(key, P);
+	return (N) ? &N->Value() : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Contains
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+bool CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::contains(std::string_view key) {
+	Node* P = nullptr;
+	return search(key, P) != nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Ordered For Each
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+template<typename FN>
+void CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::for_each(FN fn) {
+	for (typename map_type::iterator it = entries.begin(); it != entries.end(); ++it) {
+		fn(it->Key().view(), it->Value());
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Size
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+std::size_t CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::size() {
+	return entries.size();
+}
+
+//-----------------------------------------------------------------------------
+// Memory Usage - node costs from AVLmap plus the arena blocks
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+CS280::AVLmapMemory CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::memory_usage() const {
+	AVLmapMemory usage = entries.memory_usage();
+	for (std::size_t bytes : blockSizes) {
+		usage.ownedBytes += bytes;
+		usage.slackBytes += AVLmapMemory::allocationSlack(bytes);
+	}
+	return usage;
+}
+
+//-----------------------------------------------------------------------------
+// Underlying AVLmap
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+typename CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::map_type& CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::map() {
+	return entries;
+}
+
+/*!****************************************************************************
+// Class StringAVLmap Private Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Search with common prefix bounds. lcpLo / lcpHi are the bytes the query
+// shares with the closest smaller / larger key seen so far; keys in between
+// share at least the minimum of the two, so comparison resumes there.
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+typename CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::Node* CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::search(std::string_view key, Node*& parent) const {
+	std::size_t lcpLo = 0;
+	std::size_t lcpHi = 0;
+	parent = nullptr;
+
+	Node* N = entries.getRoot();
+	while (N) {
+		CompactString const& k = N->Key();
+		char const* data = k.data();
+		std::size_t n = (key.size() < k.size()) ? key.size() : k.size();
+		std::size_t i = mismatch(key.data(), data, (lcpLo < lcpHi) ? lcpLo : lcpHi, n);
+
+		bool less;
+		if (i < n) {
+			less = static_cast<unsigned char>(key[i]) < static_cast<unsigned char>(data[i]);
+		}
+		else if (key.size() == k.size()) {
+			return N;
+		}
+		else {
+			less = key.size() < k.size();
+		}
+
+		parent = N;
+		if (less) {
+			lcpHi = i;
+			N = N->Left();
+		}
+		else {
+			lcpLo = i;
+			N = N->Right();
+		}
+	}
+	return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// First index in [from, n) where a and b differ (n if none), 8 bytes a step
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+std::size_t CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::mismatch(char const* a, char const* b, std::size_t from, std::size_t n) {
+	std::size_t i = from;
+	while (i + sizeof(std::uint64_t) <= n) {
+		std::uint64_t wa, wb;
+		std::memcpy(&wa, a + i, sizeof(wa));
+		std::memcpy(&wb, b + i, sizeof(wb));
+		if (wa != wb) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+			return i + static_cast<std::size_t>(__builtin_ctzll(wa ^ wb)) / 8;
+#else
+			break;
+#endif
+		}
+		i += sizeof(std::uint64_t);
+	}
+	while (i < n && a[i] == b[i]) {
+		++i;
+	}
+	return i;
+}
+
+//-----------------------------------------------------------------------------
+// Store a key: inline when short, otherwise copied into the arena
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+CS280::CompactString CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::store(std::string_view key) {
+	std::uint32_t length = static_cast<std::uint32_t>(key.size());
+	if (length <= CompactString::inlineBytes) {
+		return CompactString(key.data(), length);
+	}
+	char* p = allocate(length);
+	std::memcpy(p, key.data(), length);
+	liveBytes += length;
+	return CompactString(p, length);
+}
+
+//-----------------------------------------------------------------------------
+// Bump allocation; keys larger than a block get a block of their own
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+char* CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::allocate(std::size_t bytes) {
+	if (bytes > left) {
+		std::size_t size = (bytes > blockBytes) ? bytes : blockBytes;
+		blocks.emplace_back(new char[size]);
+		blockSizes.push_back(size);
+		cursor = blocks.back().get();
+		left = size;
+	}
+	char* p = cursor;
+	cursor += bytes;
+	left -= bytes;
+	return p;
+}
+
+//-----------------------------------------------------------------------------
+// Copy the live keys into fresh blocks and drop the old ones. Keys keep
+// their order, so setKey() does not disturb the tree.
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE>
+void CS280::StringAVLmap<VALUE_TYPE, LAYOUT, AGGREGATE>::repack() {
+	std::vector<std::unique_ptr<char[]>> oldBlocks;
+	oldBlocks.swap(blocks);
+	blockSizes.clear();
+	cursor = nullptr;
+	left = 0;
+	liveBytes = 0;
+	deadBytes = 0;
+
+	for (typename map_type::iterator it = entries.begin(); it != entries.end(); ++it) {
+		if (!it->Key().isInline()) {
+			it->setKey(store(it->Key().view()));
+		}
+	}
+}
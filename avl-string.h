@@ -0,0 +1,121 @@
+/*!*****************************************************************************
+*\file     avl-string.h
+*\author   Jalin A. Brown
+*\brief Description:
+	String keyed AVLmap with compact keys and prefix skipping lookups.
+
+	1) CompactString - a 16 byte key: length plus 12 inline bytes. Strings
+	   up to 12 bytes live entirely inline; longer ones keep their first 4
+	   bytes inline and point at the full string in the map's arena, so a
+	   node holds no std::string and no per key heap allocation.
+	2) StringAVLmap - AVLmap<CompactString, V> that owns the arena. Lookups
+	   track the longest common prefix of the query with the nearest
+	   smaller and larger keys on the path; every key between them shares
+	   at least the smaller of the two, so each comparison starts there
+	   instead of at byte 0. Paths and URLs with long shared prefixes are
+	   compared only from where they start to differ.
+
+	Key bytes live apart from their nodes, so on maps far larger than the
+	cache a lookup can take one more miss per level than with std::string
+	keys (whose buffers usually sit next to the node); the prefix skip pays
+	off when comparisons, not misses, dominate. bench/string-keys.cpp
+	measures both sides of this trade-off.
+
+	Erased keys leave dead bytes in the arena; once they outnumber the live
+	ones the arena is repacked.
+******************************************************************************/
+
+#ifndef AVLSTRING_H
+#define AVLSTRING_H
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl.h"
+#include <string_view> // std::string_view
+#include <memory>			 // std::unique_ptr
+#include <cstdint>		 // std::uint32_t
+
+namespace CS280 {
+		//-----------------------------------------------------------------------------
+		// CompactString class declarations - a view that is either inline or into
+		// an arena; it does not own the arena bytes
+		//-----------------------------------------------------------------------------
+		class CompactString {
+			public:
+				static constexpr std::size_t inlineBytes = 12;
+
+				CompactString() = default;
+				CompactString(char const* data, std::uint32_t length); // data must outlive a non-inline key
+
+				std::size_t size() const;
+				char const* data() const;
+				std::string_view view() const;
+				bool isInline() const;
+
+			private:
+				std::uint32_t length = 0;
+				char bytes[inlineBytes] = {}; // the string, or 4 prefix bytes then a pointer
+
+				friend bool operator<(CompactString const& a, CompactString const& b);
+		};
+
+		bool operator<(CompactString const& a, CompactString const& b);
+		bool operator>(CompactString const& a, CompactString const& b);
+		bool operator==(CompactString const& a, CompactString const& b);
+
+		//-----------------------------------------------------------------------------
+		// StringAVLmap class declarations
+		//-----------------------------------------------------------------------------
+		template<typename VALUE_TYPE, typename LAYOUT = AutoValues<>, typename AGGREGATE = NoAggregate>
+		class StringAVLmap {
+		public:
+			typedef AVLmap<CompactString, VALUE_TYPE, LAYOUT, AGGREGATE> map_type;
+			typedef typename map_type::Node Node;
+
+			// BIG FOUR (keys point into the arena, so no copies)
+			StringAVLmap() = default;
+			StringAVLmap(const StringAVLmap&)            = delete;
+			StringAVLmap& operator=(const StringAVLmap&) = delete;
+			StringAVLmap(StringAVLmap&& other) noexcept;
+			StringAVLmap& operator=(StringAVLmap&& other) noexcept;
+
+			// Updates (a new key is copied into the arena, then inserted with
+			// an ordinary AVLmap descent)
+			void insert(std::string_view key, VALUE_TYPE const& value);
+			VALUE_TYPE& operator[](std::string_view key);
+			bool erase(std::string_view key);
+
+			// Prefix skipping lookups
+			VALUE_TYPE* find(std::string_view key);
+			bool contains(std::string_view key);
+
+			// Walks and getters
+			template<typename FN>
+			void for_each(FN fn); // fn(std::string_view, VALUE_TYPE&) in key order
+			std::size_t size();
+			AVLmapMemory memory_usage() const; // arena blocks count as owned bytes
+			map_type& map();
+
+		private:
+			Node* search(std::string_view key, Node*& parent) const;
+			static std::size_t mismatch(char const* a, char const* b, std::size_t from, std::size_t n);
+			CompactString store(std::string_view key); // copy long keys into the arena
+			char* allocate(std::size_t bytes);
+			void repack();
+
+			static constexpr std::size_t blockBytes = 64 * 1024;
+
+			map_type entries;
+			std::vector<std::unique_ptr<char[]>> blocks;
+			std::vector<std::size_t> blockSizes;
+			char* cursor = nullptr;  // free space in the last block
+			std::size_t left = 0;
+			std::size_t liveBytes = 0; // arena bytes of current keys
+			std::size_t deadBytes = 0; // arena bytes of erased keys
+	};
+}
+
+#include "avl-string.cpp"
+#endif
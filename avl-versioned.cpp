@@ -0,0 +1,218 @@
+/*!*****************************************************************************
+*\file     avl-versioned.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	AVLmap with version numbers and deltas for incremental replication.
+
+	Erases are logged with the epoch they ran at; the log is already in
+	epoch order, so diff() finds its start with a binary search.
+******************************************************************************/
+
+#include "avl-versioned.h"
+#include <algorithm> // std::upper_bound, std::sort, std::unique, std::remove_if
+
+/*!****************************************************************************
+// Class VersionedAVLmap Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Insert
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename BALANCE>
+void CS280::VersionedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, BALANCE>::insert(KEY_TYPE const& key, VALUE_TYPE const& value) {
+	typename map_type::iterator hint = entries.end();
+	upsert(hint, key, value, ++epoch_);
+}
+
+//-----------------------------------------------------------------------------
+// Erase - returns true if the key was present
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename BALANCE>
+bool CS280::VersionedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, BALANCE>::erase(KEY_TYPE const& key) {
+	typename map_type::iterator it = entries.find(key);
+	if (it == entries.end()) return false;
+
+	entries.erase(it);
+	eraseLog.push_back(std::make_pair(++epoch_, key));
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Find
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename BALANCE>
+VALUE_TYPE const* CS280::VersionedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, BALANCE>::find(KEY_TYPE const& key) const {
+	typename map_type::const_iterator it = entries.find(key);
+	return (it == entries.end()) ? nullptr : &it.getnode()->Value().value;
+}
+
+//-----------------------------------------------------------------------------
+// Contains
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename BALANCE>
+bool CS280::VersionedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, BALANCE>::contains(KEY_TYPE const& key) const {
+	return find(key) != nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Ordered For Each
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename BALANCE>
+template<typename FN>
+void CS280::VersionedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, BALANCE>::for_each(FN fn) const {
+	for (typename map_type::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+		fn(it->Key(), it.getnode()->Value().value);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Epoch
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename BALANCE>
+std::uint64_t CS280::VersionedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, BALANCE>::epoch() const {
+	return epoch_;
+}
+
+//-----------------------------------------------------------------------------
+// Diff - everything written or erased after since
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename BALANCE>
+bool CS280::VersionedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, BALANCE>::diff(std::uint64_t since, Delta& delta) const {
+	if (since < logFloor_ || since > epoch_) return false;
+
+	delta.from = since;
+	delta.to = epoch_;
+	delta.inserted.clear();
+	delta.updated.clear();
+	delta.erased.clear();
+	changedSince(entries.getRoot(), since, delta);
+
+	// Erased after since and not written again
+	auto first = std::upper_bound(eraseLog.begin(), eraseLog.end(), since,
+		[](std::uint64_t e, std::pair<std::uint64_t, KEY_TYPE> const& record) { return e < record.first; });
+	for (; first != eraseLog.end(); ++first) {
+		delta.erased.push_back(first->second);
+	}
+	std::sort(delta.erased.begin(), delta.erased.end());
+	delta.erased.erase(std::unique(delta.erased.begin(), delta.erased.end(),
+		[](KEY_TYPE const& a, KEY_TYPE const& b) { return !(a < b) && !(b < a); }), delta.erased.end());
+	delta.erased.erase(std::remove_if(delta.erased.begin(), delta.erased.end(),
+		[this](KEY_TYPE const& key) { return contains(key); }), delta.erased.end());
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Apply - one ascending pass, each write hinted by the previous one
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename BALANCE>
+bool CS280::VersionedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, BALANCE>::apply(Delta const& delta) {
+	if (delta.from != epoch_ || delta.to < delta.from) return false;
+	std::uint64_t stamp = delta.to;
+
+	if (entries.size() == 0 && delta.updated.empty()) {
+		// Full sync into an empty replica: linear build
+		std::vector<std::pair<KEY_TYPE, Entry>> sorted;
+		sorted.reserve(delta.inserted.size());
+		for (std::pair<KEY_TYPE, VALUE_TYPE> const& p : delta.inserted) {
+			sorted.push_back(std::make_pair(p.first, Entry(p.second, stamp, stamp)));
+		}
+		entries.assignSorted(sorted.begin(), sorted.end());
+	}
+	else {
+		// Merge the two sorted lists so the hint only moves forward
+		typename map_type::iterator hint = entries.end();
+		std::size_t i = 0;
+		std::size_t u = 0;
+		while (i < delta.inserted.size() || u < delta.updated.size()) {
+			bool takeInserted = u == delta.updated.size() ||
+			                    (i < delta.inserted.size() && delta.inserted[i].first < delta.updated[u].first);
+			std::pair<KEY_TYPE, VALUE_TYPE> const& p = (takeInserted) ? delta.inserted[i++] : delta.updated[u++];
+			upsert(hint, p.first, p.second, stamp);
+		}
+	}
+
+	typename map_type::iterator hint = entries.end();
+	for (KEY_TYPE const& key : delta.erased) {
+		typename map_type::iterator it = entries.find_near(hint, key);
+		if (it == entries.end()) continue;
+		hint = it;
+		++hint; // Erase relinks nodes, so the successor stays valid
+		entries.erase(it);
+		eraseLog.push_back(std::make_pair(stamp, key));
+	}
+
+	epoch_ = stamp;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Trim Log
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename BALANCE>
+void CS280::VersionedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, BALANCE>::trimLog(std::uint64_t upTo) {
+	if (upTo > epoch_) upTo = epoch_;
+	if (upTo <= logFloor_) return;
+
+	auto last = std::upper_bound(eraseLog.begin(), eraseLog.end(), upTo,
+		[](std::uint64_t e, std::pair<std::uint64_t, KEY_TYPE> const& record) { return e < record.first; });
+	eraseLog.erase(eraseLog.begin(), last);
+	logFloor_ = upTo;
+}
+
+//-----------------------------------------------------------------------------
+// Size
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename BALANCE>
+std::size_t CS280::VersionedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, BALANCE>::size() const {
+	return entries.size();
+}
+
+//-----------------------------------------------------------------------------
+// Erase records kept
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename BALANCE>
+std::size_t CS280::VersionedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, BALANCE>::logSize() const {
+	return eraseLog.size();
+}
+
+//-----------------------------------------------------------------------------
+// Underlying AVLmap
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename BALANCE>
+typename CS280::VersionedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, BALANCE>::map_type const& CS280::VersionedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, BALANCE>::map() const {
+	return entries;
+}
+
+/*!****************************************************************************
+// Class VersionedAVLmap Private Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// In-order walk of the entries modified after since, skipping every subtree
+// whose newest stamp is not
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename BALANCE>
+void CS280::VersionedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, BALANCE>::changedSince(Node* node, std::uint64_t since, Delta& delta) const {
+	if (!node || node->Aggregate() <= since) return;
+
+	changedSince(node->Left(), since, delta);
+	Entry const& e = node->Value();
+	if (e.modified > since) {
+		std::vector<std::pair<KEY_TYPE, VALUE_TYPE>>& list = (e.created > since) ? delta.inserted : delta.updated;
+		list.push_back(std::make_pair(node->Key(), e.value));
+	}
+	changedSince(node->Right(), since, delta);
+}
+
+//-----------------------------------------------------------------------------
+// Insert or overwrite with a stamp; an overwrite keeps the created epoch.
+// hint moves to the written entry.
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename BALANCE>
+void CS280::VersionedAVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, BALANCE>::upsert(typename map_type::iterator& hint, KEY_TYPE const& key, VALUE_TYPE const& value, std::uint64_t stamp) {
+	std::size_t before = entries.size();
+	hint = entries.emplace_hint(hint, key, value, stamp, stamp);
+	if (entries.size() == before) {
+		hint->setValue(Entry(value, hint->Value().created, stamp)); // setValue refreshes the stamps above
+	}
+}
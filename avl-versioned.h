@@ -0,0 +1,105 @@
+/*!*****************************************************************************
+*\file     avl-versioned.h
+*\author   Jalin A. Brown
+*\brief Description:
+	AVLmap with version numbers and deltas for incremental replication.
+
+	Every write advances the map's epoch and stamps the entry with it. The
+	stamps are kept as a max-epoch subtree aggregate (the AGGREGATE policy
+	of AVLmap), so diff(since) skips every subtree whose newest stamp is
+	not after since: k changed entries cost O(k log n), not O(n). Erased
+	keys leave no node to stamp, so they go to an erase log kept in epoch
+	order.
+
+	A Delta holds the inserted, updated and erased keys between two epochs,
+	each in key order. apply() merges it into a replica in one ascending
+	pass of hinted inserts (an empty replica is built in O(n) with
+	assignSorted), then stamps the replica with the delta's epoch so it can
+	serve diffs itself.
+
+	trimLog(epoch) drops erase records up to epoch once every replica has
+	passed it; diff() refuses (returns false) to start before that point.
+******************************************************************************/
+
+#ifndef AVLVERSIONED_H
+#define AVLVERSIONED_H
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl.h"
+#include <cstdint> // std::uint64_t
+#include <utility> // std::pair
+
+namespace CS280 {
+		//-----------------------------------------------------------------------------
+		// VersionedAVLmap class declarations
+		//-----------------------------------------------------------------------------
+		template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT = AutoValues<>, typename BALANCE = StrictAVL>
+		class VersionedAVLmap {
+		public:
+			// Entry - the AVLmap value: user value plus the epochs that wrote it
+			struct Entry {
+				Entry(VALUE_TYPE const& v = VALUE_TYPE(), std::uint64_t c = 0, std::uint64_t m = 0) : value(v), created(c), modified(m) {}
+
+				VALUE_TYPE    value;
+				std::uint64_t created;  // epoch of the insert
+				std::uint64_t modified; // epoch of the last write
+			};
+
+			// Newest modified epoch in a subtree
+			struct EpochAggregate {
+				static constexpr bool enabled = true;
+				typedef std::uint64_t value_type;
+				template<typename K>
+				static value_type lift(K const&, Entry const& e) { return e.modified; }
+				static value_type combine(value_type a, value_type b) { return (a < b) ? b : a; }
+			};
+
+			typedef AVLmap<KEY_TYPE, Entry, LAYOUT, EpochAggregate, BALANCE> map_type;
+			typedef typename map_type::Node Node;
+
+			// Changes that take a replica from epoch from to epoch to
+			struct Delta {
+				std::uint64_t from = 0;
+				std::uint64_t to   = 0;
+				std::vector<std::pair<KEY_TYPE, VALUE_TYPE>> inserted; // key order
+				std::vector<std::pair<KEY_TYPE, VALUE_TYPE>> updated;  // key order
+				std::vector<KEY_TYPE> erased;                          // key order; may name keys the replica never saw
+			};
+
+			// Writes (each advances the epoch)
+			void insert(KEY_TYPE const& key, VALUE_TYPE const& value); // overwrites like AVLmap::insert
+			bool erase(KEY_TYPE const& key);
+
+			// Reads
+			VALUE_TYPE const* find(KEY_TYPE const& key) const;
+			bool contains(KEY_TYPE const& key) const;
+			template<typename FN>
+			void for_each(FN fn) const; // fn(key, value) in key order
+
+			// Versions
+			std::uint64_t epoch() const;
+			bool diff(std::uint64_t since, Delta& delta) const; // false if since is trimmed or in the future
+			bool apply(Delta const& delta);                     // false unless delta.from == epoch()
+			void trimLog(std::uint64_t upTo);                   // forget erases at or before upTo
+
+			// Getters
+			std::size_t size() const;
+			std::size_t logSize() const;
+			map_type const& map() const;
+
+		private:
+			void changedSince(Node* node, std::uint64_t since, Delta& delta) const;
+			void upsert(typename map_type::iterator& hint, KEY_TYPE const& key, VALUE_TYPE const& value, std::uint64_t stamp);
+
+			map_type entries;
+			std::vector<std::pair<std::uint64_t, KEY_TYPE>> eraseLog; // (epoch, key), epoch order
+			std::uint64_t epoch_    = 0;
+			std::uint64_t logFloor_ = 0; // erases at or before this were trimmed
+	};
+}
+
+#include "avl-versioned.cpp"
+#endif
@@ -1,918 +1,2979 @@
-/*!*****************************************************************************
-*\file     avl.cpp
-*\author   Jalin A. Brown
-*\brief Description:
-	Self balancing binary search tree (AVL tree) implementation.
-
-	API is exactly the same. You just add rebalancing.
-
-	Implement:
-	1) rotations - both left and right
-	2) balance calculation
-	3) AVL logic - this step will require modification of the BST insert and erase
-******************************************************************************/
-
-#include "avl-map.h"
-#include <iostream>
-
-/*!****************************************************************************
-// Class AVLmap->Node Public Methods
-******************************************************************************/
-
-//-----------------------------------------------------------------------------
-// CTOR
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node::Node
-(
-	KEY_TYPE k,
-	VALUE_TYPE val,
-	Node* p,
-	int h,
-	int b,
-	Node* l,
-	Node* r
-) : key(k), value(val), parent(p), height(h), balance(b), left(l), right(r)
-{}
-
-//-----------------------------------------------------------------------------
-// Key Getter
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-KEY_TYPE const& CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node::Key() const {
-	  return key;
-}
-
-//-----------------------------------------------------------------------------
-// Value Getter
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-VALUE_TYPE& CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node::Value() {
-	  return value;
-}
-
-//-----------------------------------------------------------------------------
-// First Node
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node::first() {
-  // Traverse to the furthest left leaf node and return it  
-	Node* N = this;
-	while (N->left) 
-	{
-    N = N->left;
-  }
-  return N;
-}
-
-//-----------------------------------------------------------------------------
-// Last Node
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node::last() {
-	// Traverse to the furthest right leaf node and return it
-	Node* N = this;
-	while (N->right) 
-	{
-    N = N->right;
-  }
-  return N;
-}
-
-//-----------------------------------------------------------------------------
-// Increment Node
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node::increment() {
-  // If the right child exists, return the leftmost node of the right subtree
-	Node* N = this;
-	if (N->right) {
-    return N->right->first();
-  }
-
-	// Otherwise, return the first ancestor whose left child is also an ancestor of N
-	while ((N->parent) && (N == N->parent->right))
-	{
-    N = N->parent;
-  }
-
-  return N->parent; // Return the parent node
-}
-
-//-----------------------------------------------------------------------------
-// Decrement Node
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node::decrement() {
-  // If the left child exists, return the rightmost node of the left subtree
-	Node* N = this;
-	if (N->left) {
-    return N->left->last();
-  }
-
-	// Otherwise, return the first ancestor whose right child is also an ancestor of N
-	while (N->parent && N == N->parent->left) {
-    N = N->parent;
-  }
-
-  return N->parent; // Return the parent node
-}
-
-//-----------------------------------------------------------------------------
-// Print Node
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node::print(std::ostream& os) const {
-	// Print the key-value 
-	os << key << " -> " << value << std::endl;
-}
-
-//-----------------------------------------------------------------------------
-// Check if Node has Key
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-bool CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node::hasKey(KEY_TYPE const& k)
-{
-	// If the key is found, return true, otherwise return false
-	if (k == key) return true;
-  return false;
-}
-
-//-----------------------------------------------------------------------------
-// Get Node Height
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-int CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node::getHeight() const {
-	// If the node is null, return -1, otherwise return the height of the node
-	int leftHeight = (left) ? left->height : -1;
-	int rightHeight = (right) ? right->height : -1;
-
-	// Return the max height of the node whether left heavy or right heavy
-	return 1 + std::max(leftHeight, rightHeight);
-}
-
-//-----------------------------------------------------------------------------
-// Get Node Balance
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-int CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node::getBalanceFactor() const {
-	// If the node is null, return 0, otherwise return the balance factor of the node
-	int leftHeight = (left) ? left->height : -1;
-	int rightHeight = (right) ? right->height : -1;
-	return leftHeight - rightHeight;
-}
-
-//-----------------------------------------------------------------------------
-// Update Node Height
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node::updateHeight() {
-	int leftHeight = (left) ? left->height : -1;
-	int rightHeight = (right) ? right->height : -1;
-	height = 1 + std::max(leftHeight, rightHeight);
-}
-
-//-----------------------------------------------------------------------------
-// Key & Value Setter methods (just in case)
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node::setKey(const KEY_TYPE& newKey){
-  key = newKey;
-}
-
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node::setValue(const VALUE_TYPE& newValue){
-  value = newValue;
-}
-
-/*!****************************************************************************
-//  Static data members
-******************************************************************************/
-
-//-----------------------------------------------------------------------------
-// end_it , initialized to nullptr
-//-----------------------------------------------------------------------------
-template< typename KEY_TYPE, typename VALUE_TYPE >
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator
-CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::end_it = CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator(nullptr);
-
-//-----------------------------------------------------------------------------
-// const_end_it , initialized to nullptr
-//-----------------------------------------------------------------------------
-template< typename KEY_TYPE, typename VALUE_TYPE >
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const
-CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::const_end_it = CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const(nullptr);
-
-
-/*!****************************************************************************
-// Struct AVLmap->AVLmap_iterator Private Methods
-******************************************************************************/
-
-//-----------------------------------------------------------------------------
-// CTOR
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator::AVLmap_iterator(Node* p) : p_node(p) {
-}
-
-//-----------------------------------------------------------------------------
-// Copy CTOR
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator::AVLmap_iterator(const AVLmap_iterator& rhs) {
-  p_node = rhs.p_node;
-}
-
-//-----------------------------------------------------------------------------
-// Operator=
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator& CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator::operator=(const AVLmap_iterator& rhs) {
-	if (this != &rhs) {
-		p_node = rhs.p_node;
-	}
-	return *this;
-}
-
-//-----------------------------------------------------------------------------
-// Operator++
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator& CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator::operator++() {
-	p_node = p_node->increment();
-	return *this;
-}
-
-//-----------------------------------------------------------------------------
-// Operator++ int
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator::operator++(int) {
-	AVLmap_iterator tmp = *this;
-	p_node = p_node->increment();
-	return tmp;
-}
-
-//-----------------------------------------------------------------------------
-// Operator*
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node& CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator::operator*() {
-	return *p_node;
-}
-
-//-----------------------------------------------------------------------------
-// Operator->
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator::operator->() {
-	return p_node;
-}
-
-//-----------------------------------------------------------------------------
-// Operator!=
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-bool CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator::operator!=(const AVLmap_iterator& rhs) {
-  return p_node != rhs.p_node;
-}
-
-//-----------------------------------------------------------------------------
-// Operator==
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-bool CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator::operator==(const AVLmap_iterator& rhs) {
-  return p_node == rhs.p_node;
-}
-
-//-----------------------------------------------------------------------------
-// Find and return node with given key or end_it if not found
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::find(KEY_TYPE const& key) {
-	// Traverse the tree to find the node with the given key
-	Node* N = pRoot;
-	while (N) {
-		if (key < N->key) {
-			N = N->left;
-		}
-		else if (key > N->key) {
-			N = N->right;
-		}
-		else {
-			return AVLmap_iterator(N); // Return the non-const iterator to the node
-		}
-	}
-	return end_it; // Return the end const iterator if the key is not found
-}
-
-/*!****************************************************************************
-// Struct AVLmap->AVLmap_iterator_const Private Methods
-******************************************************************************/
-
-//-----------------------------------------------------------------------------
-// CTOR
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const::AVLmap_iterator_const(Node* p) : p_node(p) {
-}
-
-//-----------------------------------------------------------------------------
-// Operator=
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const& CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const::operator=(const AVLmap_iterator_const& rhs) {
-	p_node = rhs.p_node;
-	return *this;
-}
-
-//-----------------------------------------------------------------------------
-// Operator++
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const& CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const::operator++() {
-	p_node = p_node->increment();
-	return *this;
-}
-
-//-----------------------------------------------------------------------------
-// Operator++ int
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const::operator++(int) {
-	AVLmap_iterator_const tmp = *this;
-	p_node = p_node->increment();
-	return tmp;
-}
-
-//-----------------------------------------------------------------------------
-// Operator*
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node const& CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const::operator*() {
-  return *p_node;
-}
-
-//-----------------------------------------------------------------------------
-// Operator->
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node const* CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const::operator->() {
-	return p_node;
-}
-
-//-----------------------------------------------------------------------------
-// Operator!=
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-bool CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const::operator!=(const AVLmap_iterator_const& rhs) {
-  return p_node != rhs.p_node;
-}
-
-//-----------------------------------------------------------------------------
-// Operator==
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-bool CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const::operator==(const AVLmap_iterator_const& rhs) {
-  return p_node == rhs.p_node;
-}
-
-/*!****************************************************************************
-// Class AVLmap Public Methods
-******************************************************************************/
-
-//-----------------------------------------------------------------------------
-// CTOR
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap() {
-}
-
-//-----------------------------------------------------------------------------
-// Copy CTOR
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap(const AVLmap& rhs) {
-	// If the source tree is not empty, copy the tree, starting from the root
-	if (rhs.pRoot) {
-		pRoot = new Node
-		(
-			rhs.pRoot->key,
-			rhs.pRoot->value,
-			nullptr,
-			0,  // Height and balance are updated during copy
-			0,
-			nullptr,
-			nullptr
-		);
-		copyTree(pRoot, rhs.pRoot); // Copy the tree recursively
-	}
-
-	size_ = rhs.size_; // Copy the size of the source tree
-}
-
-//-----------------------------------------------------------------------------
-// Operator=
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-CS280::AVLmap<KEY_TYPE, VALUE_TYPE>& CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::operator=(const AVLmap& rhs) {
-    // Check for self-assignment
-    if (this != &rhs) {
-        // Clear the current tree
-        clear();
-
-        // If the source tree is not empty, copy the tree, starting from the root
-        if (rhs.pRoot) {
-            pRoot = new Node
-            (
-                rhs.pRoot->key,
-                rhs.pRoot->value,
-                nullptr,
-                rhs.pRoot->height,
-                rhs.pRoot->balance,
-                nullptr,
-                nullptr
-            );
-
-            copyTree(pRoot, rhs.pRoot);
-        }
-
-        size_ = rhs.size_;
-    }
-
-    return *this; // Return the current tree
-}
-
-//-----------------------------------------------------------------------------
-// ~DTOR
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::~AVLmap() {
-	clear(); // Clear the tree
-}
-
-//-----------------------------------------------------------------------------
-// Size
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-unsigned int CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::size() {
-  return size_;
-}
-
-//-----------------------------------------------------------------------------
-// Copy the tree recursively
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::copyTree(Node* dest, const Node* src) {
-	if (!src) return; // Base case for recursion
-
-	// Delete existing nodes in the destination tree
-	if (dest->left) delete dest->left;
-	if (dest->right) delete dest->right;
-
-	// Copy the node and recursively copy left and right subtrees
-	dest->key = src->key;
-	dest->value = src->value;
-	if (src->left) {
-		// Create node with parent pointer
-		dest->left = new Node(src->left->key, src->left->value, dest, 1, 0, nullptr, nullptr); 
-		copyTree(dest->left, src->left);
-	}
-	if (src->right) {
-		// Create node with parent pointer
-		dest->right = new Node(src->right->key, src->right->value, dest, 1, 0, nullptr, nullptr); 
-		copyTree(dest->right, src->right);
-	}
-
-	// Update balance and height of the copied nodes after copying
-	dest->balance = dest->getBalanceFactor();
-	dest->height = dest->getHeight();
-}
-
-//-----------------------------------------------------------------------------
-// Operator[]
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-VALUE_TYPE& CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::operator[](KEY_TYPE const& key) {
-	// Find the node with the given key
-	Node* N = pRoot;
-	while (N) {
-		if (key < N->key) {
-			N = N->left;
-		}
-		else if (key > N->key) {
-			N = N->right;
-		}
-		else {
-			return N->value; // Return the value of the node
-		}
-	}
-
-	// If the key is not found, insert the key-value pair and return the value
-	insert(key, VALUE_TYPE());
-	return find(key)->value;
-}
-
-//-----------------------------------------------------------------------------
-// Insert AVL Node
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::insert(KEY_TYPE const& key, VALUE_TYPE const& value) {
-	Node* N = pRoot;
-	Node* P = nullptr;
-
-	// Traverse the tree to find the appropriate position to insert the new node
-	while (N) {
-		P = N;
-		if (key < N->key) {
-			N = N->left;
-		}
-		else if (key > N->key) {
-			N = N->right;
-		}
-		else {
-			// Key already exists, update the value and return
-			N->setValue(value); // Use the setter function for value
-			return;
-		}
-	}
-
-	// Create a new node to insert
-	Node* newNode = new Node(key, value, nullptr, 0, 0, nullptr, nullptr);
-	if (!P) {
-		pRoot = newNode; // Tree is empty, set the new node as the root
-	}
-	else if (key < P->key) {
-		P->left = newNode;
-		newNode->parent = P;
-	}
-	else {
-		P->right = newNode;
-		newNode->parent = P;
-	}
-
-	++size_; // Increment the size of the tree
-
-	// Update balance, height, and perform AVL balancing starting from the parent node
-	updateBalanceAfterInsert(P);
-
-	// Update pRoot if a new root node was inserted
-	if (pRoot && pRoot->parent != nullptr) {
-		pRoot = pRoot->parent;
-	}
-}
-
-//-----------------------------------------------------------------------------
-// Update Tree Balance After Insertion
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::updateBalanceAfterInsert(Node* node) {
-	while (node) {
-		node->balance = node->getBalanceFactor(); // Update balance factor
-		node->height = node->getHeight();         // Update height
-
-		// Check if the balance factor is greater than 1 (left-heavy subtree)
-		if (node->balance > 1) {
-			// Check if the left subtree of the node is right-heavy
-			if (node->left && node->left->balance < 0) {
-				node->left = leftRotate(node->left); // Perform left-right rotation
-			}
-			node = rightRotate(node); // Perform right rotation
-		}
-		// Check if the balance factor is less than -1 (right-heavy subtree)
-		else if (node->balance < -1) {
-			// Check if the right subtree of the node is left-heavy
-			if (node->right && node->right->balance > 0) {
-				node->right = rightRotate(node->right); // Perform right-left rotation
-			}
-			node = leftRotate(node); // Perform left rotation
-		}
-
-		if (node) {
-			node = node->parent; // Move to the parent for further balancing
-		}
-	}
-}
-
-//-----------------------------------------------------------------------------
-//AVLmap begin() method dealing with non-const iterator 
-//-----------------------------------------------------------------------------
-template< typename KEY_TYPE, typename VALUE_TYPE >
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::begin() {
-	if (pRoot)
-		return AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator(pRoot->first());
-	else
-		return end_it;
-}
-
-//-----------------------------------------------------------------------------
-//AVLmap end() method dealing with non-const iterator 
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::end() {
-	return end_it;
-}
-
-//-----------------------------------------------------------------------------
-//AVLmap begin() method dealing with CONST iterator 
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::begin() const {
-  if (pRoot) 
-		return AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const(pRoot->first());
-  else       
-		return const_end_it;
-}
-
-//-----------------------------------------------------------------------------
-//AVLmap end() method dealing with CONST iterator
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::end() const {
-	return const_end_it;
-}
-
-//-----------------------------------------------------------------------------
-// Find and return node with given key or const_end_it if not found
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap_iterator_const CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::find(KEY_TYPE const& key) const {
-	Node* N = pRoot;
-	while (N) {
-		if (key < N->key) {
-			N = N->left;
-		}
-		else if (key > N->key) {
-			N = N->right;
-		}
-		else {
-			return AVLmap_iterator_const(N);
-		}
-	}
-
-	return const_end_it;
-}
-
-//-----------------------------------------------------------------------------
-// Erase
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::erase(AVLmap_iterator it) {
-	Node* N = it.p_node;
-	if (!N) {
-		return; // Check for null pointer
-	}
-
-	// Case 1: Node has no children
-	if (!N->left && !N->right) {
-		if (N->parent) {
-			if (N->parent->left == N) {
-				N->parent->left = nullptr;
-			}
-			else {
-				N->parent->right = nullptr;
-			}
-		}
-		else {
-			pRoot = nullptr; // Update root if deleting the root node
-		}
-		delete N; // Free the memory allocated for the node
-	}
-	// Case 2: Node has one child
-	else if (!N->left || !N->right) {
-		Node* child = (N->left) ? N->left : N->right;
-		if (N->parent) {
-			if (N->parent->left == N) {
-				N->parent->left = child;
-			}
-			else {
-				N->parent->right = child;
-			}
-		}
-		else {
-			pRoot = child; // Update root if deleting the root node
-		}
-		if (child) {
-			child->parent = N->parent;
-		}
-		delete N; // Free the memory allocated for the node
-	}
-	// Case 3: Node has two children
-	else {
-		Node* successor = N->right->first(); // Find the successor node
-		N->key = successor->key;						 // Replace key with successor key
-		N->value = successor->value;				 // Replace value with successor value
-		erase(successor);										 // Recursively delete the successor node
-	}
-
-	--size_; // Decrement the size of the tree
-}
-
-//-----------------------------------------------------------------------------
-// Update Tree Balance after deleting (AVL Balancing)
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::updateBalanceAfterDelete(Node* node) {
-	while (node) {
-		node->balance = node->getBalanceFactor();
-		node->height = node->getHeight();
-
-		if (node->balance > 1) {
-			if (node->right && node->right->getBalanceFactor() < 0) {
-				// Double rotation: right-left case
-				rightRotate(node->right);
-			}
-			// Single rotation: left case
-			leftRotate(node);
-		}
-		else if (node->balance < -1) {
-			if (node->left && node->left->getBalanceFactor() > 0) {
-				// Double rotation: left-right case
-				leftRotate(node->left);
-			}
-			// Single rotation: right case
-			rightRotate(node);
-		}
-
-		node = node->parent; // Move to the parent for further balancing
-	}
-}
-
-//-----------------------------------------------------------------------------
-// AVLmap Rotation Methods - (Y) (U)se (V)olks (W)agon ?!?!
-// y - Node being rotated
-// u - Left child of y (if it exists)
-// v - Right child of y (if it exists)
-// w - Right child of v (if it exists)
-//-----------------------------------------------------------------------------
-//-----------------------------------------------------------------------------
-// Left Rotation
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::leftRotate(Node* y) {
-	if (!y || !y->right) {
-		return nullptr; // Check for null pointers
-	}
-
-	Node* subTreeNewRoot = y->right;
-	Node* v = subTreeNewRoot->left;
-
-	// Perform rotation
-	subTreeNewRoot->left = y;
-	y->right = v;
-
-	// Update parent pointers
-	subTreeNewRoot->parent = y->parent;
-	if (y->parent) {
-		if (y->parent->left == y) {
-			y->parent->left = subTreeNewRoot;
-		}
-		else {
-			y->parent->right = subTreeNewRoot;
-		}
-	}
-	y->parent = subTreeNewRoot;
-	if (v) {
-		v->parent = y;
-	}
-
-	// Update heights
-	// For node y, update its height by taking the maximum height between its 
-	// left and right children (if they exist) and adding 1.
-	y->height = std::max(y->left ? y->left->height : -1, y->right ? y->right->height : -1) + 1;
-
-	// For the new root of the rotated subtree (subTreeNewRoot), update its height
-	//  by considering the max height between its left and right children (if they exist) and adding 1.
-	subTreeNewRoot->height = 
-		std::max(subTreeNewRoot->left ? subTreeNewRoot->left->height : -1,
-			       subTreeNewRoot->right ? subTreeNewRoot->right->height : -1) + 1;
-
-	return subTreeNewRoot;
-}
-
-//-----------------------------------------------------------------------------
-// Right Rotation
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::rightRotate(Node* y) {
-	if (!y || !y->left) {
-		return nullptr; // Check for null pointers
-	}
-
-	Node* subTreeNewRoot = y->left;  // left child of y as the new root of the subtree
-	Node* v = subTreeNewRoot->right; // right child of the new root (if it exists)
-
-	// Right rotation
-	subTreeNewRoot->right = y; // Make y the right child of the new root
-	y->left = v; // Make v the left child of y 
-
-	// Update parent pointer
-	subTreeNewRoot->parent = y->parent; // Update the parent of new root
-
-	// If y has a parent
-	if (y->parent) { 
-		if (y->parent->left == y) {
-			y->parent->left = subTreeNewRoot; // Update left child of y's parent to the new root
-		}
-		else {
-			y->parent->right = subTreeNewRoot; // Update right child of y's parent to the new root
-		}
-	}
-
-	// Update y's parent to be the new root
-	y->parent = subTreeNewRoot; 
-	if (v) {
-		v->parent = y; // If v exists, update its parent to be y
-	}
-
-	// Update heights
-	y->height = std::max(y->left ? y->left->height : -1, y->right ? y->right->height : -1) + 1;
-	
-	subTreeNewRoot->height = 
-		std::max(subTreeNewRoot->left ? subTreeNewRoot->left->height : -1,
-					  subTreeNewRoot->right ? subTreeNewRoot->right->height : -1) + 1;
-
-	return subTreeNewRoot;
-}
-
-//-----------------------------------------------------------------------------
-// Clear Tree
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::clear() {
-	while (pRoot) {
-		erase(begin());
-	}
-}
-
-//-----------------------------------------------------------------------------
-// Get Depth
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-int CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::getdepth(Node* b) const {
-	int depth = 0;
-	while (b->parent) {
-		++depth;
-		b = b->parent;
-	}
-	return depth;
-}
-
-//-----------------------------------------------------------------------------
-// Update Heights
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::updateHeights(Node* node) {
-	while (node) {
-		node->height = std::max(node->left ? node->left->height : -1, 
-													  node->right ? node->right->height : -1) + 1;
-		node = node->parent;
-	}
-}
-
-//-----------------------------------------------------------------------------
-// Update Tree Balance
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::updateBalance(Node* node) {
-	// Update balance and height of the node and its children
-	if (node) {
-		node->balance = node->getBalanceFactor(); // Update balance
-		node->height = node->getHeight(); // Update height after balance
-		updateBalance(node->left); // Update balance of left child
-		updateBalance(node->right); // Update balance of right child
-	}
-}
-
-//-----------------------------------------------------------------------------
-// Return Height of Node
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-int CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::getHeight(Node* node) {
-	return node->height;
-}
-
-//-----------------------------------------------------------------------------
-// Move Constructor (noexcept)
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::AVLmap(AVLmap&& other) noexcept
-	: pRoot(other.pRoot), size_(other.size_) {	
-	other.pRoot = nullptr; // Transfer ownership, set source to null
-	other.size_ = 0;       // Reset the size of the source tree
-}
-
-//-----------------------------------------------------------------------------
-// Move Assignment Operator (noexcept)
-//-----------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-CS280::AVLmap<KEY_TYPE, VALUE_TYPE>& CS280::AVLmap<KEY_TYPE, VALUE_TYPE>::operator=(AVLmap&& other) noexcept {
-	if (this != &other) {		 // Check for self-assignment
-		clear();							 // Clear current tree
-		pRoot = other.pRoot;	 // Transfer ownership of root
-		size_ = other.size_;	 // Transfer ownership of size
-		other.pRoot = nullptr; // Reset source tree
-		other.size_ = 0;       // Reset source size
-	}
-	return *this;
-}
\ No newline at end of file
+/*!*****************************************************************************
+*\file     avl.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	Self balancing binary search tree (AVL tree) implementation.
+
+	API is exactly the same. You just add rebalancing.
+
+	Implement:
+	1) rotations - both left and right
+	2) balance calculation
+	3) AVL logic - this step will require modification of the BST insert and erase
+******************************************************************************/
+
+#include "avl.h"
+#include <iostream>
+#include <cmath>
+#include <new>
+#include <iterator>
+
+/*!****************************************************************************
+// Class ValueSlab Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Move CTOR
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE>
+CS280::ValueSlab<VALUE_TYPE>::ValueSlab(ValueSlab&& other) noexcept
+	: chunks(std::move(other.chunks)), freeList(other.freeList), nextChunk(other.nextChunk), slots(other.slots) {
+	other.chunks.clear();
+	other.freeList = nullptr;
+	other.nextChunk = 16;
+	other.slots = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Move Assignment (live values must already have been released)
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE>
+CS280::ValueSlab<VALUE_TYPE>& CS280::ValueSlab<VALUE_TYPE>::operator=(ValueSlab&& other) noexcept {
+	if (this != &other) {
+		for (Slot* chunk : chunks) {
+			delete[] chunk;
+		}
+		chunks = std::move(other.chunks);
+		freeList = other.freeList;
+		nextChunk = other.nextChunk;
+		slots = other.slots;
+		other.chunks.clear();
+		other.freeList = nullptr;
+		other.nextChunk = 16;
+		other.slots = 0;
+	}
+	return *this;
+}
+
+//-----------------------------------------------------------------------------
+// ~DTOR (the owning map releases every value before this runs)
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE>
+CS280::ValueSlab<VALUE_TYPE>::~ValueSlab() {
+	for (Slot* chunk : chunks) {
+		delete[] chunk;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Copy a value into a free slot, growing by a new chunk when none is left
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE>
+VALUE_TYPE* CS280::ValueSlab<VALUE_TYPE>::acquire(VALUE_TYPE value) {
+	if (!freeList) {
+		Slot* chunk = new Slot[nextChunk];
+		chunks.push_back(chunk);
+		// Thread the new slots onto the free list in address order
+		for (std::size_t i = nextChunk; i > 0; --i) {
+			chunk[i - 1].next = freeList;
+			freeList = &chunk[i - 1];
+		}
+		slots += nextChunk;
+		if (nextChunk < 4096) nextChunk *= 2;
+	}
+
+	Slot* slot = freeList;
+	freeList = slot->next; // Unlink before the value overwrites the link
+	return new (slot->storage) VALUE_TYPE(std::move(value));
+}
+
+//-----------------------------------------------------------------------------
+// Destroy a value and return its slot to the free list
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE>
+void CS280::ValueSlab<VALUE_TYPE>::release(VALUE_TYPE* value) {
+	value->~VALUE_TYPE();
+	Slot* slot = reinterpret_cast<Slot*>(value);
+	slot->next = freeList;
+	freeList = slot;
+}
+
+//-----------------------------------------------------------------------------
+// Memory - live slots are value bytes, free slots and chunk overhead slack
+//-----------------------------------------------------------------------------
+template<typename VALUE_TYPE>
+void CS280::ValueSlab<VALUE_TYPE>::memory(std::size_t live, AVLmapMemory& usage) const {
+	usage.valueBytes += live * sizeof(Slot);
+	usage.slackBytes += (slots - live) * sizeof(Slot) + chunks.capacity() * sizeof(Slot*);
+
+	// Chunk sizes follow the same doubling as acquire()
+	std::size_t chunkSlots = 16;
+	for (std::size_t i = 0; i < chunks.size(); ++i) {
+		usage.slackBytes += AVLmapMemory::allocationSlack(chunkSlots * sizeof(Slot));
+		if (chunkSlots < 4096) chunkSlots *= 2;
+	}
+}
+
+/*!****************************************************************************
+// Class NodeRegions Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Move CTOR
+//-----------------------------------------------------------------------------
+template<typename NODE>
+CS280::NodeRegions<NODE>::NodeRegions(NodeRegions&& other) noexcept
+	: blocks(std::move(other.blocks)), filling(other.filling) {
+	other.blocks.clear();
+	other.filling = false;
+}
+
+//-----------------------------------------------------------------------------
+// Move Assignment (live nodes must already have been destroyed)
+//-----------------------------------------------------------------------------
+template<typename NODE>
+CS280::NodeRegions<NODE>& CS280::NodeRegions<NODE>::operator=(NodeRegions&& other) noexcept {
+	if (this != &other) {
+		while (!blocks.empty()) {
+			free(blocks.size() - 1);
+		}
+		blocks = std::move(other.blocks);
+		filling = other.filling;
+		other.blocks.clear();
+		other.filling = false;
+	}
+	return *this;
+}
+
+//-----------------------------------------------------------------------------
+// ~DTOR (the owning map destroys every node before this runs)
+//-----------------------------------------------------------------------------
+template<typename NODE>
+CS280::NodeRegions<NODE>::~NodeRegions() {
+	while (!blocks.empty()) {
+		free(blocks.size() - 1);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Open a block of the given size
+//-----------------------------------------------------------------------------
+template<typename NODE>
+void CS280::NodeRegions<NODE>::open(std::size_t nodes) {
+	close();
+	Block block{ std::allocator<NODE>().allocate(nodes), nodes, 0, 0 };
+	blocks.push_back(block);
+	filling = true;
+}
+
+//-----------------------------------------------------------------------------
+// Take the next slot (the caller constructs a node in it)
+//-----------------------------------------------------------------------------
+template<typename NODE>
+void* CS280::NodeRegions<NODE>::take() {
+	Block& block = blocks.back();
+	++block.live;
+	return block.storage + block.used++;
+}
+
+//-----------------------------------------------------------------------------
+// Close the open block
+//-----------------------------------------------------------------------------
+template<typename NODE>
+void CS280::NodeRegions<NODE>::close() {
+	if (!filling) return;
+	filling = false;
+	if (blocks.back().live == 0) {
+		free(blocks.size() - 1);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Destroy a node living in a block; the block goes when its last node does
+//-----------------------------------------------------------------------------
+template<typename NODE>
+bool CS280::NodeRegions<NODE>::destroy(NODE* node) {
+	for (std::size_t i = 0; i < blocks.size(); ++i) {
+		Block& block = blocks[i];
+		if (node < block.storage || node >= block.storage + block.used) continue;
+
+		node->~NODE();
+		if (--block.live == 0 && !(filling && i + 1 == blocks.size())) {
+			free(i);
+		}
+		return true;
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// Is node in a block
+//-----------------------------------------------------------------------------
+template<typename NODE>
+bool CS280::NodeRegions<NODE>::owns(NODE const* node) const {
+	for (Block const& block : blocks) {
+		if (node >= block.storage && node < block.storage + block.used) return true;
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// Nodes in blocks
+//-----------------------------------------------------------------------------
+template<typename NODE>
+std::size_t CS280::NodeRegions<NODE>::live() const {
+	std::size_t count = 0;
+	for (Block const& block : blocks) {
+		count += block.live;
+	}
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// Slots in blocks
+//-----------------------------------------------------------------------------
+template<typename NODE>
+std::size_t CS280::NodeRegions<NODE>::capacity() const {
+	std::size_t count = 0;
+	for (Block const& block : blocks) {
+		count += block.capacity;
+	}
+	return count;
+}
+
+/*!****************************************************************************
+// Class NodeRegions Private Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Free a block
+//-----------------------------------------------------------------------------
+template<typename NODE>
+void CS280::NodeRegions<NODE>::free(std::size_t index) {
+	std::allocator<NODE>().deallocate(blocks[index].storage, blocks[index].capacity);
+	blocks.erase(blocks.begin() + static_cast<std::ptrdiff_t>(index));
+}
+
+/*!****************************************************************************
+// Struct AVLmapStats Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Reset all counters
+//-----------------------------------------------------------------------------
+inline void CS280::AVLmapStats::reset() {
+	*this = AVLmapStats();
+}
+
+//-----------------------------------------------------------------------------
+// Dump counters as "name value" lines
+//-----------------------------------------------------------------------------
+inline void CS280::AVLmapStats::print(std::ostream& os) const {
+	os << "lookups "         << lookups        << std::endl;
+	os << "comparisons "     << comparisons    << std::endl;
+	os << "left_rotations "  << leftRotations  << std::endl;
+	os << "right_rotations " << rightRotations << std::endl;
+	os << "retraces "        << retraces       << std::endl;
+	os << "retrace_steps "   << retraceSteps   << std::endl;
+	os << "max_retrace "     << maxRetrace     << std::endl;
+	os << "allocations "     << allocations    << std::endl;
+	os << "deallocations "   << deallocations  << std::endl;
+	for (std::size_t d = 0; d < depthHistogram.size(); ++d) {
+		os << "depth_" << d << " " << depthHistogram[d] << std::endl;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Dump shape as "name value" lines
+//-----------------------------------------------------------------------------
+inline void CS280::AVLmapShape::print(std::ostream& os) const {
+	os << "size "          << size         << std::endl;
+	os << "height "        << height       << std::endl;
+	os << "height_bound "  << heightBound  << std::endl;
+	os << "average_depth " << averageDepth << std::endl;
+}
+
+/*!****************************************************************************
+// Struct AVLmapMemory Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Total bytes
+//-----------------------------------------------------------------------------
+inline std::size_t CS280::AVLmapMemory::total() const {
+	return nodeBytes + valueBytes + slackBytes + ownedBytes;
+}
+
+//-----------------------------------------------------------------------------
+// Dump usage as "name value" lines
+//-----------------------------------------------------------------------------
+inline void CS280::AVLmapMemory::print(std::ostream& os) const {
+	os << "nodes "       << nodes      << std::endl;
+	os << "node_bytes "  << nodeBytes  << std::endl;
+	os << "value_bytes " << valueBytes << std::endl;
+	os << "slack_bytes " << slackBytes << std::endl;
+	os << "owned_bytes " << ownedBytes << std::endl;
+	os << "total_bytes " << total()    << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+// Estimated allocator overhead for one allocation of `bytes`: a one word
+// header, rounded up to 16 bytes, 32 bytes minimum (glibc-like)
+//-----------------------------------------------------------------------------
+inline std::size_t CS280::AVLmapMemory::allocationSlack(std::size_t bytes) {
+	std::size_t chunk = (bytes + sizeof(void*) + 15) / 16 * 16;
+	if (chunk < 32) chunk = 32;
+	return chunk - bytes;
+}
+
+/*!****************************************************************************
+// Class AVLmapBudget Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// CTOR
+//-----------------------------------------------------------------------------
+inline CS280::AVLmapBudget::AVLmapBudget(std::size_t limit, callback_type onExceeded)
+	: limitBytes(limit), exceeded(std::move(onExceeded)) {
+}
+
+//-----------------------------------------------------------------------------
+// Reserve - retries for as long as the callback reports it made room
+//-----------------------------------------------------------------------------
+inline bool CS280::AVLmapBudget::reserve(std::size_t bytes) {
+	for (;;) {
+		std::size_t now = usedBytes.load(std::memory_order_relaxed);
+		while (now + bytes <= limitBytes.load(std::memory_order_relaxed)) {
+			if (usedBytes.compare_exchange_weak(now, now + bytes, std::memory_order_relaxed)) {
+				return true;
+			}
+		}
+		if (!exceeded || !exceeded(bytes, *this)) {
+			return false;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Charge without checking the limit
+//-----------------------------------------------------------------------------
+inline void CS280::AVLmapBudget::charge(std::size_t bytes) {
+	usedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+// Release
+//-----------------------------------------------------------------------------
+inline void CS280::AVLmapBudget::release(std::size_t bytes) {
+	usedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+// Getters / Setters
+//-----------------------------------------------------------------------------
+inline std::size_t CS280::AVLmapBudget::used() const {
+	return usedBytes.load(std::memory_order_relaxed);
+}
+
+inline std::size_t CS280::AVLmapBudget::limit() const {
+	return limitBytes.load(std::memory_order_relaxed);
+}
+
+inline void CS280::AVLmapBudget::setLimit(std::size_t limit) {
+	limitBytes.store(limit, std::memory_order_relaxed);
+}
+
+inline void CS280::AVLmapBudget::setCallback(callback_type onExceeded) {
+	exceeded = std::move(onExceeded);
+}
+
+/*!****************************************************************************
+// Class AVLmap->Node Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// CTOR
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::Node
+(
+	KEY_TYPE k,
+	value_slot val,
+	Node* p,
+	int h,
+	int b,
+	Node* l,
+	Node* r
+) : key(std::move(k)), value(std::move(val)), parent(p), left(l), right(r), height(h), balance(b)
+{}
+
+//-----------------------------------------------------------------------------
+// Key Getter
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+KEY_TYPE const& CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::Key() const {
+	  return key;
+}
+
+//-----------------------------------------------------------------------------
+// Value Getter
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+VALUE_TYPE& CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::Value() {
+	  return value.get();
+}
+
+//-----------------------------------------------------------------------------
+// Link Getters
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::Left() const {
+	return left;
+}
+
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::Right() const {
+	return right;
+}
+
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::Parent() const {
+	return parent;
+}
+
+//-----------------------------------------------------------------------------
+// First Node
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::first() {
+  // Traverse to the furthest left leaf node and return it  
+	Node* N = this;
+	while (N->left) 
+	{
+    N = N->left;
+  }
+  return N;
+}
+
+//-----------------------------------------------------------------------------
+// Last Node
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::last() {
+	// Traverse to the furthest right leaf node and return it
+	Node* N = this;
+	while (N->right) 
+	{
+    N = N->right;
+  }
+  return N;
+}
+
+//-----------------------------------------------------------------------------
+// Increment Node
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::increment() {
+  // If the right child exists, return the leftmost node of the right subtree
+	Node* N = this;
+	if (N->right) {
+    return N->right->first();
+  }
+
+	// Otherwise, return the first ancestor whose left child is also an ancestor of N
+	while ((N->parent) && (N == N->parent->right))
+	{
+    N = N->parent;
+  }
+
+  return N->parent; // Return the parent node
+}
+
+//-----------------------------------------------------------------------------
+// Decrement Node
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::decrement() {
+  // If the left child exists, return the rightmost node of the left subtree
+	Node* N = this;
+	if (N->left) {
+    return N->left->last();
+  }
+
+	// Otherwise, return the first ancestor whose right child is also an ancestor of N
+	while (N->parent && N == N->parent->left) {
+    N = N->parent;
+  }
+
+  return N->parent; // Return the parent node
+}
+
+//-----------------------------------------------------------------------------
+// Print Node
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::print(std::ostream& os) const {
+	// Print the key-value 
+	os << key << " -> " << value.get() << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+// Check if Node has Key
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+bool CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::hasKey(KEY_TYPE const& k)
+{
+	// If the key is found, return true, otherwise return false
+	if (k == key) return true;
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+// Get Node Height
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+int CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::getHeight() const {
+	// If the node is null, return -1, otherwise return the height of the node
+	int leftHeight = (left) ? left->height : -1;
+	int rightHeight = (right) ? right->height : -1;
+
+	// Return the max height of the node whether left heavy or right heavy
+	return 1 + std::max(leftHeight, rightHeight);
+}
+
+//-----------------------------------------------------------------------------
+// Get Node Balance
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+int CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::getBalanceFactor() const {
+	// If the node is null, return 0, otherwise return the balance factor of the node
+	int leftHeight = (left) ? left->height : -1;
+	int rightHeight = (right) ? right->height : -1;
+	return leftHeight - rightHeight;
+}
+
+//-----------------------------------------------------------------------------
+// Update Node Height
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::updateHeight() {
+	int leftHeight = (left) ? left->height : -1;
+	int rightHeight = (right) ? right->height : -1;
+	height = 1 + std::max(leftHeight, rightHeight);
+}
+
+//-----------------------------------------------------------------------------
+// Key & Value Setter methods (just in case)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::setKey(const KEY_TYPE& newKey){
+  key = newKey;
+	if constexpr (AGGREGATE::enabled) {
+		for (Node* N = this; N; N = N->parent) N->updateAggregate();
+	}
+}
+
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::setValue(const VALUE_TYPE& newValue){
+  value.get() = newValue;
+	if constexpr (AGGREGATE::enabled) {
+		for (Node* N = this; N; N = N->parent) N->updateAggregate();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Subtree Aggregate Getter
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename AGGREGATE::value_type const& CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::Aggregate() const {
+	return this->agg;
+}
+
+//-----------------------------------------------------------------------------
+// Recompute the subtree aggregate from the children (no-op without a policy)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node::updateAggregate() {
+	if constexpr (AGGREGATE::enabled) {
+		typename AGGREGATE::value_type result = AGGREGATE::lift(key, value.get());
+		if (left)  result = AGGREGATE::combine(left->agg, result);
+		if (right) result = AGGREGATE::combine(result, right->agg);
+		this->agg = result;
+	}
+}
+
+/*!****************************************************************************
+//  Static data members
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// end_it , initialized to nullptr
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::end_it = CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator(nullptr);
+
+//-----------------------------------------------------------------------------
+// const_end_it , initialized to nullptr
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::const_end_it = CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const(nullptr);
+
+
+/*!****************************************************************************
+// Struct AVLmap->AVLmap_iterator Private Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// CTOR
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator::AVLmap_iterator(Node* p) : p_node(p) {
+}
+
+//-----------------------------------------------------------------------------
+// Copy CTOR
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator::AVLmap_iterator(const AVLmap_iterator& rhs) {
+  p_node = rhs.p_node;
+}
+
+//-----------------------------------------------------------------------------
+// Operator=
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator& CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator::operator=(const AVLmap_iterator& rhs) {
+	if (this != &rhs) {
+		p_node = rhs.p_node;
+	}
+	return *this;
+}
+
+//-----------------------------------------------------------------------------
+// Operator++
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator& CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator::operator++() {
+	p_node = p_node->increment();
+	return *this;
+}
+
+//-----------------------------------------------------------------------------
+// Operator++ int
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator::operator++(int) {
+	AVLmap_iterator tmp = *this;
+	p_node = p_node->increment();
+	return tmp;
+}
+
+//-----------------------------------------------------------------------------
+// Operator*
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node& CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator::operator*() {
+	return *p_node;
+}
+
+//-----------------------------------------------------------------------------
+// Operator->
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator::operator->() {
+	return p_node;
+}
+
+//-----------------------------------------------------------------------------
+// Operator!=
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+bool CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator::operator!=(const AVLmap_iterator& rhs) {
+  return p_node != rhs.p_node;
+}
+
+//-----------------------------------------------------------------------------
+// Operator==
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+bool CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator::operator==(const AVLmap_iterator& rhs) {
+  return p_node == rhs.p_node;
+}
+
+//-----------------------------------------------------------------------------
+// Find and return node with given key or end_it if not found
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::find(KEY_TYPE const& key) {
+	// Traverse the tree to find the node with the given key
+	Node* N = pRoot;
+	AVLMAP_STAT(++stats_.lookups);
+	while (N) {
+		AVLMAP_STAT(++stats_.comparisons);
+		if (key < N->key) {
+			N = N->left;
+		}
+		else if (key > N->key) {
+			N = N->right;
+		}
+		else {
+			return AVLmap_iterator(N); // Return the non-const iterator to the node
+		}
+	}
+	return end_it; // Return the end const iterator if the key is not found
+}
+
+/*!****************************************************************************
+// Struct AVLmap->AVLmap_iterator_const Private Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// CTOR
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const::AVLmap_iterator_const(Node* p) : p_node(p) {
+}
+
+//-----------------------------------------------------------------------------
+// Copy CTOR
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const::AVLmap_iterator_const(const AVLmap_iterator_const& rhs) : p_node(rhs.p_node) {
+}
+
+//-----------------------------------------------------------------------------
+// Operator=
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const& CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const::operator=(const AVLmap_iterator_const& rhs) {
+	p_node = rhs.p_node;
+	return *this;
+}
+
+//-----------------------------------------------------------------------------
+// Operator++
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const& CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const::operator++() {
+	p_node = p_node->increment();
+	return *this;
+}
+
+//-----------------------------------------------------------------------------
+// Operator++ int
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const::operator++(int) {
+	AVLmap_iterator_const tmp = *this;
+	p_node = p_node->increment();
+	return tmp;
+}
+
+//-----------------------------------------------------------------------------
+// Operator*
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node const& CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const::operator*() {
+  return *p_node;
+}
+
+//-----------------------------------------------------------------------------
+// Operator->
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node const* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const::operator->() {
+	return p_node;
+}
+
+//-----------------------------------------------------------------------------
+// Operator!=
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+bool CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const::operator!=(const AVLmap_iterator_const& rhs) {
+  return p_node != rhs.p_node;
+}
+
+//-----------------------------------------------------------------------------
+// Operator==
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+bool CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const::operator==(const AVLmap_iterator_const& rhs) {
+  return p_node == rhs.p_node;
+}
+
+/*!****************************************************************************
+// Class AVLmap_node_handle Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Move CTOR
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_node_handle::AVLmap_node_handle(AVLmap_node_handle&& other) noexcept
+	: node(other.node), detached(std::move(other.detached)) {
+	other.node = nullptr;
+	if constexpr (separateValues) {
+		other.detached.reset();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Move Assignment
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_node_handle& CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_node_handle::operator=(AVLmap_node_handle&& other) noexcept {
+	if (this != &other) {
+		delete node;
+		node = other.node;
+		detached = std::move(other.detached);
+		other.node = nullptr;
+		if constexpr (separateValues) {
+			other.detached.reset();
+		}
+	}
+	return *this;
+}
+
+//-----------------------------------------------------------------------------
+// ~DTOR - an entry that was never re-inserted is destroyed here (its map
+// already counted it in deallocations when it was extracted)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_node_handle::~AVLmap_node_handle() {
+	delete node;
+}
+
+//-----------------------------------------------------------------------------
+// Empty
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+bool CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_node_handle::empty() const {
+	return node == nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Operator bool
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_node_handle::operator bool() const {
+	return node != nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Key
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+KEY_TYPE const& CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_node_handle::key() const {
+	return node->key;
+}
+
+//-----------------------------------------------------------------------------
+// Value
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+VALUE_TYPE& CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_node_handle::value() {
+	if constexpr (separateValues) {
+		return *detached;
+	}
+	else {
+		return node->value.get();
+	}
+}
+
+/*!****************************************************************************
+// Class AVLmap Public Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// CTOR
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap() {
+}
+
+//-----------------------------------------------------------------------------
+// Copy CTOR
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap(const AVLmap& rhs) {
+	budget_ = rhs.budget_; // The copy is charged to the same budget
+	copyFrom(rhs);
+}
+
+//-----------------------------------------------------------------------------
+// Operator=
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>& CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::operator=(const AVLmap& rhs) {
+    // Check for self-assignment
+    if (this != &rhs) {
+        // Clear the current tree
+        clear();
+
+        // Charged to this map's budget; a failed copy leaves the map empty
+        copyFrom(rhs);
+    }
+
+    return *this; // Return the current tree
+}
+
+//-----------------------------------------------------------------------------
+// ~DTOR
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::~AVLmap() {
+	clear(); // Clear the tree
+}
+
+//-----------------------------------------------------------------------------
+// Size
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::size_type CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::size() const {
+  return size_;
+}
+
+//-----------------------------------------------------------------------------
+// Copy the tree recursively (new nodes are not charged to the budget; the
+// copy constructor and assignment reserve for the whole tree first)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::copyTree(Node* dest, const Node* src) {
+	if (!src) return; // Base case for recursion
+
+	// Delete existing nodes in the destination tree
+	if (dest->left) destroyNode(dest->left);
+	if (dest->right) destroyNode(dest->right);
+
+	// Copy the node and recursively copy left and right subtrees
+	dest->key = src->key;
+	dest->value.get() = src->value.get();
+	if (src->left) {
+		// Create node with parent pointer
+		dest->left = allocateNode(src->left->key, src->left->value.get(), dest);
+		copyTree(dest->left, src->left);
+	}
+	if (src->right) {
+		// Create node with parent pointer
+		dest->right = allocateNode(src->right->key, src->right->value.get(), dest);
+		copyTree(dest->right, src->right);
+	}
+
+	// Same shape, so the balancing fields carry over as they are
+	dest->balance = src->balance;
+	dest->height = src->height;
+	dest->updateAggregate();
+}
+
+//-----------------------------------------------------------------------------
+// Copy rhs into this empty map. The whole copy is reserved up front; if a
+// key or value copy throws, the partial tree is destroyed (returning its
+// nodes' charge) and the rest of the reservation is released
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::copyFrom(const AVLmap& rhs) {
+	if (budget_ && !budget_->reserve(rhs.size_ * nodeCharge)) {
+		throw std::bad_alloc();
+	}
+	if (!rhs.pRoot) return;
+
+	try {
+		// Height and balance are copied along with the shape
+		pRoot = allocateNode(rhs.pRoot->key, rhs.pRoot->value.get(), nullptr);
+		copyTree(pRoot, rhs.pRoot); // Every node is linked before its children are copied
+	}
+	catch (...) {
+		size_type built = destroySubtree(pRoot);
+		pRoot = nullptr;
+		if (budget_) budget_->release((rhs.size_ - built) * nodeCharge);
+		throw;
+	}
+	size_ = rhs.size_;
+}
+
+//-----------------------------------------------------------------------------
+// Bulk load from sorted pairs - no comparisons, no rotations
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+template<typename ITER>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::assignSorted(ITER first, ITER last) {
+	clear();
+	std::size_t count = static_cast<std::size_t>(std::distance(first, last));
+	if (budget_ && !budget_->reserve(count * nodeCharge)) {
+		throw std::bad_alloc();
+	}
+	pRoot = buildSorted(first, count, 0, sortedRedDepth(count));
+	size_ = count;
+}
+
+//-----------------------------------------------------------------------------
+// Operator[]
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+VALUE_TYPE& CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::operator[](KEY_TYPE const& key) {
+	// Find the node with the given key
+	Node* P = nullptr;
+	bool left = false;
+	Node* N = descend(pRoot, key, P, left);
+	if (!N) {
+		// If the key is not found, attach a default value where the search ended
+		N = createNode(key, VALUE_TYPE(), nullptr);
+		attach(P, left, N);
+	}
+
+	// The caller may write through the reference: refresh its path later
+	if constexpr (AGGREGATE::enabled) {
+		if (!N->pending) {
+			N->pending = true;
+			pendingAggregates_.push_back(N);
+		}
+	}
+	return N->value.get(); // Return the value of the node
+}
+
+//-----------------------------------------------------------------------------
+// Insert AVL Node
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::insert(KEY_TYPE const& key, VALUE_TYPE const& value) {
+	// Traverse the tree to find the appropriate position to insert the new node
+	Node* P = nullptr;
+	bool left = false;
+	Node* N = descend(pRoot, key, P, left);
+	if (N) {
+		// Key already exists, update the value and return
+		N->setValue(value); // Use the setter function for value
+		return;
+	}
+
+	// Create a new node to insert
+	attach(P, left, createNode(key, value, nullptr));
+}
+
+//-----------------------------------------------------------------------------
+// Hinted Insert - descent starts from the hint (see fingerStart)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::insert(AVLmap_iterator hint, KEY_TYPE const& key, VALUE_TYPE const& value) {
+	Node* P = nullptr;
+	bool left = false;
+	Node* N = descend(fingerStart(hint.p_node, key), key, P, left);
+	if (N) {
+		N->setValue(value);
+		return AVLmap_iterator(N);
+	}
+
+	N = createNode(key, value, nullptr);
+	attach(P, left, N);
+	return AVLmap_iterator(N);
+}
+
+//-----------------------------------------------------------------------------
+// Hinted Emplace - builds the value from args only if the key is new
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+template<typename... ARGS>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::emplace_hint(AVLmap_iterator hint, KEY_TYPE const& key, ARGS&&... args) {
+	Node* P = nullptr;
+	bool left = false;
+	Node* N = descend(fingerStart(hint.p_node, key), key, P, left);
+	if (N) {
+		return AVLmap_iterator(N); // Existing value is left untouched
+	}
+
+	N = createNode(key, VALUE_TYPE(std::forward<ARGS>(args)...), nullptr);
+	attach(P, left, N);
+	return AVLmap_iterator(N);
+}
+
+//-----------------------------------------------------------------------------
+// Finger Find - search starts from the hint instead of pRoot
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::find_near(AVLmap_iterator hint, KEY_TYPE const& key) {
+	Node* P = nullptr;
+	bool left = false;
+	Node* N = descend(fingerStart(hint.p_node, key), key, P, left);
+	return (N) ? AVLmap_iterator(N) : end_it;
+}
+
+//-----------------------------------------------------------------------------
+// Link a freshly created node below P (nullptr = empty tree) on the side
+// descend chose and rebalance; no key is compared, so this cannot throw
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::attach(Node* P, bool left, Node* newNode) {
+	if (!P) {
+		pRoot = newNode; // Tree is empty, set the new node as the root
+	}
+	else if (left) {
+		P->left = newNode;
+		newNode->parent = P;
+	}
+	else {
+		P->right = newNode;
+		newNode->parent = P;
+	}
+
+	++size_; // Increment the size of the tree
+
+	// Rebalance per policy, starting from the parent node
+	if constexpr (BALANCE::kind == BalanceKind::StrictAVL) {
+		updateBalanceAfterInsert(P);
+	}
+	else if constexpr (BALANCE::kind == BalanceKind::RelaxedAVL) {
+		relaxedInsertFixup(newNode);
+	}
+	else {
+		redBlackInsertFixup(newNode);
+	}
+	refreshAggregates(newNode->parent); // The retrace may stop below the root
+
+	// Update pRoot if a new root node was inserted
+	if (pRoot && pRoot->parent != nullptr) {
+		pRoot = pRoot->parent;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Update Tree Balance After Insertion
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::updateBalanceAfterInsert(Node* node) {
+#ifdef AVLMAP_ENABLE_STATS
+	unsigned long long steps = 0;
+	++stats_.retraces;
+#endif
+	while (node) {
+		AVLMAP_STAT(++steps);
+		int oldHeight = node->height;
+		node->balance = node->getBalanceFactor(); // Update balance factor
+		node->height = node->getHeight();         // Update height
+
+		// Check if the balance factor is greater than 1 (left-heavy subtree)
+		if (node->balance > 1) {
+			// Check if the left subtree of the node is right-heavy
+			if (node->left && node->left->balance < 0) {
+				node->left = leftRotate(node->left); // Perform left-right rotation
+			}
+			rightRotate(node); // Perform right rotation
+			break;             // Rotated subtree is back to its old height
+		}
+		// Check if the balance factor is less than -1 (right-heavy subtree)
+		else if (node->balance < -1) {
+			// Check if the right subtree of the node is left-heavy
+			if (node->right && node->right->balance > 0) {
+				node->right = rightRotate(node->right); // Perform right-left rotation
+			}
+			leftRotate(node); // Perform left rotation
+			break;            // Rotated subtree is back to its old height
+		}
+		else if (node->height == oldHeight) {
+			break; // Height unchanged, nothing above can be affected
+		}
+
+		node = node->parent; // Move to the parent for further balancing
+	}
+#ifdef AVLMAP_ENABLE_STATS
+	stats_.retraceSteps += steps;
+	if (steps > stats_.maxRetrace) stats_.maxRetrace = steps;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//AVLmap begin() method dealing with non-const iterator 
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::begin() {
+	if (pRoot)
+		return AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator(pRoot->first());
+	else
+		return end_it;
+}
+
+//-----------------------------------------------------------------------------
+//AVLmap end() method dealing with non-const iterator 
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::end() {
+	return end_it;
+}
+
+//-----------------------------------------------------------------------------
+//AVLmap begin() method dealing with CONST iterator 
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::begin() const {
+  if (pRoot) 
+		return AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const(pRoot->first());
+  else       
+		return const_end_it;
+}
+
+//-----------------------------------------------------------------------------
+//AVLmap end() method dealing with CONST iterator
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::end() const {
+	return const_end_it;
+}
+
+//-----------------------------------------------------------------------------
+// Find and return node with given key or const_end_it if not found
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator_const CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::find(KEY_TYPE const& key) const {
+	Node* N = pRoot;
+	AVLMAP_STAT(++stats_.lookups);
+	while (N) {
+		AVLMAP_STAT(++stats_.comparisons);
+		if (key < N->key) {
+			N = N->left;
+		}
+		else if (key > N->key) {
+			N = N->right;
+		}
+		else {
+			return AVLmap_iterator_const(N);
+		}
+	}
+
+	return const_end_it;
+}
+
+//-----------------------------------------------------------------------------
+// Erase
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::erase(AVLmap_iterator it) {
+	Node* N = it.p_node;
+	if (!N) {
+		return; // Check for null pointer
+	}
+	detach(N);
+	destroyNode(N); // Free the memory allocated for the node
+}
+
+//-----------------------------------------------------------------------------
+// Detach - unlink N and rebalance; N itself is left for the caller
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::detach(Node* N) {
+	flushAggregates(); // Pending nodes may be about to go away
+	abandonCompaction(); // The plan may hold N
+	Node* P = N->parent; // Retrace starts here
+	Node* X = nullptr;   // Subtree that took the removed position (RedBlack fix-up)
+	bool removedBlack;   // Colour leaving the tree
+
+	// Case 1: Node has no children
+	if (!N->left && !N->right) {
+		if (N->parent) {
+			if (N->parent->left == N) {
+				N->parent->left = nullptr;
+			}
+			else {
+				N->parent->right = nullptr;
+			}
+		}
+		else {
+			pRoot = nullptr; // Update root if deleting the root node
+		}
+		removedBlack = !isRed(N);
+	}
+	// Case 2: Node has one child
+	else if (!N->left || !N->right) {
+		Node* child = (N->left) ? N->left : N->right;
+		X = child;
+		if (N->parent) {
+			if (N->parent->left == N) {
+				N->parent->left = child;
+			}
+			else {
+				N->parent->right = child;
+			}
+		}
+		else {
+			pRoot = child; // Update root if deleting the root node
+		}
+		if (child) {
+			child->parent = N->parent;
+		}
+		removedBlack = !isRed(N);
+	}
+	// Case 3: Node has two children - relink the successor into N's place so
+	// no key or value moves and iterators to other nodes stay valid
+	else {
+		Node* successor = N->right->first(); // Find the successor node
+		X = successor->right;
+		if (successor == N->right) {
+			P = successor; // Successor keeps its right subtree and moves up
+		}
+		else {
+			P = successor->parent; // Successor leaves a hole on P's left
+			P->left = successor->right;
+			if (successor->right) {
+				successor->right->parent = P;
+			}
+			successor->right = N->right;
+			N->right->parent = successor;
+		}
+		successor->left = N->left;
+		N->left->parent = successor;
+
+		successor->parent = N->parent;
+		if (N->parent) {
+			if (N->parent->left == N) {
+				N->parent->left = successor;
+			}
+			else {
+				N->parent->right = successor;
+			}
+		}
+		else {
+			pRoot = successor; // Update root if deleting the root node
+		}
+
+		// Rank and colour belong to the position: the successor takes N's, and
+		// N carries the successor's colour out (that is the one removed)
+		std::swap(successor->height, N->height);
+		std::swap(successor->balance, N->balance);
+		removedBlack = !isRed(N);
+	}
+
+	--size_; // Decrement the size of the tree
+
+	// Rebalance per policy from the parent of the removed position
+	if constexpr (BALANCE::kind == BalanceKind::StrictAVL) {
+		updateBalanceAfterDelete(P); // Runs to the root
+	}
+	else if constexpr (BALANCE::kind == BalanceKind::RelaxedAVL) {
+		refreshAggregates(P); // No rebalancing: ranks only ever loosen
+	}
+	else {
+		if (removedBlack) {
+			redBlackEraseFixup(X, P);
+		}
+		refreshAggregates(P);
+	}
+	while (pRoot && pRoot->parent) {
+		pRoot = pRoot->parent;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Update Tree Balance after deleting (AVL Balancing)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::updateBalanceAfterDelete(Node* node) {
+	while (node) {
+		node->balance = node->getBalanceFactor();
+		node->height = node->getHeight();
+		node->updateAggregate(); // Deletion retrace always runs to the root
+
+		if (node->balance > 1) {
+			if (node->left && node->left->getBalanceFactor() < 0) {
+				// Double rotation: left-right case
+				leftRotate(node->left);
+			}
+			// Single rotation: right case
+			node = rightRotate(node);
+		}
+		else if (node->balance < -1) {
+			if (node->right && node->right->getBalanceFactor() > 0) {
+				// Double rotation: right-left case
+				rightRotate(node->right);
+			}
+			// Single rotation: left case
+			node = leftRotate(node);
+		}
+
+		node = node->parent; // Move to the parent for further balancing
+	}
+}
+
+//-----------------------------------------------------------------------------
+// AVLmap Rotation Methods - (Y) (U)se (V)olks (W)agon ?!?!
+// y - Node being rotated
+// u - Left child of y (if it exists)
+// v - Right child of y (if it exists)
+// w - Right child of v (if it exists)
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Left Rotation
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::leftRotate(Node* y) {
+	if (!y || !y->right) {
+		return nullptr; // Check for null pointers
+	}
+	AVLMAP_STAT(++stats_.leftRotations);
+
+	Node* subTreeNewRoot = y->right;
+	Node* v = subTreeNewRoot->left;
+
+	// Perform rotation
+	subTreeNewRoot->left = y;
+	y->right = v;
+
+	// Update parent pointers
+	subTreeNewRoot->parent = y->parent;
+	if (y->parent) {
+		if (y->parent->left == y) {
+			y->parent->left = subTreeNewRoot;
+		}
+		else {
+			y->parent->right = subTreeNewRoot;
+		}
+	}
+	y->parent = subTreeNewRoot;
+	if (v) {
+		v->parent = y;
+	}
+
+	// Update heights (StrictAVL only; the other policies set ranks / colours
+	// in their fix-ups)
+	if constexpr (BALANCE::kind == BalanceKind::StrictAVL) {
+		// For node y, update its height by taking the maximum height between its 
+		// left and right children (if they exist) and adding 1.
+		y->height = std::max(y->left ? y->left->height : -1, y->right ? y->right->height : -1) + 1;
+		y->balance = y->getBalanceFactor();
+
+		// For the new root of the rotated subtree (subTreeNewRoot), update its height
+		//  by considering the max height between its left and right children (if they exist) and adding 1.
+		subTreeNewRoot->height = 
+			std::max(subTreeNewRoot->left ? subTreeNewRoot->left->height : -1,
+				       subTreeNewRoot->right ? subTreeNewRoot->right->height : -1) + 1;
+		subTreeNewRoot->balance = subTreeNewRoot->getBalanceFactor();
+	}
+	y->updateAggregate();
+	subTreeNewRoot->updateAggregate();
+
+	return subTreeNewRoot;
+}
+
+//-----------------------------------------------------------------------------
+// Right Rotation
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::rightRotate(Node* y) {
+	if (!y || !y->left) {
+		return nullptr; // Check for null pointers
+	}
+	AVLMAP_STAT(++stats_.rightRotations);
+
+	Node* subTreeNewRoot = y->left;  // left child of y as the new root of the subtree
+	Node* v = subTreeNewRoot->right; // right child of the new root (if it exists)
+
+	// Right rotation
+	subTreeNewRoot->right = y; // Make y the right child of the new root
+	y->left = v; // Make v the left child of y 
+
+	// Update parent pointer
+	subTreeNewRoot->parent = y->parent; // Update the parent of new root
+
+	// If y has a parent
+	if (y->parent) { 
+		if (y->parent->left == y) {
+			y->parent->left = subTreeNewRoot; // Update left child of y's parent to the new root
+		}
+		else {
+			y->parent->right = subTreeNewRoot; // Update right child of y's parent to the new root
+		}
+	}
+
+	// Update y's parent to be the new root
+	y->parent = subTreeNewRoot; 
+	if (v) {
+		v->parent = y; // If v exists, update its parent to be y
+	}
+
+	// Update heights (StrictAVL only, as in leftRotate)
+	if constexpr (BALANCE::kind == BalanceKind::StrictAVL) {
+		y->height = std::max(y->left ? y->left->height : -1, y->right ? y->right->height : -1) + 1;
+		y->balance = y->getBalanceFactor();
+
+		subTreeNewRoot->height = 
+			std::max(subTreeNewRoot->left ? subTreeNewRoot->left->height : -1,
+						  subTreeNewRoot->right ? subTreeNewRoot->right->height : -1) + 1;
+		subTreeNewRoot->balance = subTreeNewRoot->getBalanceFactor();
+	}
+	y->updateAggregate();
+	subTreeNewRoot->updateAggregate();
+
+	return subTreeNewRoot;
+}
+
+//-----------------------------------------------------------------------------
+// Clear Tree
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::clear() {
+	abandonCompaction();
+	pendingAggregates_.clear(); // Their nodes are going away
+	destroySubtree(pRoot);      // No rebalancing on the way out
+	pRoot = nullptr;
+	size_ = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Get Depth
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+int CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::getdepth(Node* b) const {
+	int depth = 0;
+	while (b->parent) {
+		++depth;
+		b = b->parent;
+	}
+	return depth;
+}
+
+//-----------------------------------------------------------------------------
+// Get Root
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::getRoot() const {
+	return pRoot;
+}
+
+//-----------------------------------------------------------------------------
+// Update Heights
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::updateHeights(Node* node) {
+	while (node) {
+		node->height = std::max(node->left ? node->left->height : -1, 
+													  node->right ? node->right->height : -1) + 1;
+		node = node->parent;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Update Tree Balance
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::updateBalance(Node* node) {
+	if (!node) return;
+
+	// Post-order walk over parent pointers (children before parents, no recursion)
+	Node* N = node;
+	while (N->left || N->right) {
+		N = (N->left) ? N->left : N->right;
+	}
+	for (;;) {
+		N->height = N->getHeight();         // Children are already up to date
+		N->balance = N->getBalanceFactor();
+		N->updateAggregate();
+		if (N == node) break;
+
+		Node* P = N->parent;
+		if (N == P->left && P->right) {
+			// Continue with the deepest first node of the right sibling
+			N = P->right;
+			while (N->left || N->right) {
+				N = (N->left) ? N->left : N->right;
+			}
+		}
+		else {
+			N = P;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Return Height of Node
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+int CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::getHeight(Node* node) {
+	return node->height;
+}
+
+//-----------------------------------------------------------------------------
+// Move Constructor (noexcept)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap(AVLmap&& other) noexcept
+	: pRoot(other.pRoot), size_(other.size_), slab_(std::move(other.slab_)), pendingAggregates_(std::move(other.pendingAggregates_)), budget_(other.budget_) {	
+	other.abandonCompaction();
+	regions_ = std::move(other.regions_); // Compacted nodes keep their blocks
+	other.pRoot = nullptr; // Transfer ownership, set source to null
+	other.size_ = 0;       // Reset the size of the source tree
+}
+
+//-----------------------------------------------------------------------------
+// Move Assignment Operator (noexcept)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>& CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::operator=(AVLmap&& other) noexcept {
+	if (this != &other) {		 // Check for self-assignment
+		clear();							 // Clear current tree
+		if (budget_ != other.budget_) { // The nodes stay charged to this map's budget
+			if (other.budget_) other.budget_->release(other.size_ * nodeCharge);
+			if (budget_) budget_->charge(other.size_ * nodeCharge);
+		}
+		pRoot = other.pRoot;	 // Transfer ownership of root
+		size_ = other.size_;	 // Transfer ownership of size
+		slab_ = std::move(other.slab_); // Values follow their nodes
+		other.abandonCompaction();
+		regions_ = std::move(other.regions_); // So do compacted nodes' blocks
+		pendingAggregates_ = std::move(other.pendingAggregates_);
+		other.pendingAggregates_.clear();
+		other.pRoot = nullptr; // Reset source tree
+		other.size_ = 0;       // Reset source size
+	}
+	return *this;
+}
+
+/*!****************************************************************************
+// Class AVLmap Private Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Charge the budget, then allocate a leaf node; over budget throws before
+// anything is allocated or linked
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::createNode(KEY_TYPE const& key, VALUE_TYPE value, Node* parent) {
+	if (!budget_) {
+		return allocateNode(key, std::move(value), parent);
+	}
+	if (!budget_->reserve(nodeCharge)) {
+		throw std::bad_alloc();
+	}
+	try {
+		return allocateNode(key, std::move(value), parent);
+	}
+	catch (...) {
+		budget_->release(nodeCharge);
+		throw;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Allocate a leaf node (every node allocation goes through here)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::allocateNode(KEY_TYPE const& key, VALUE_TYPE value, Node* parent) {
+	AVLMAP_STAT(++stats_.allocations);
+	Node* N;
+	if constexpr (separateValues) {
+		N = new Node(key, value_slot(slab_.acquire(std::move(value))), parent, 0, 0, nullptr, nullptr);
+	}
+	else {
+		N = new Node(key, value_slot(std::move(value)), parent, 0, 0, nullptr, nullptr);
+	}
+	N->updateAggregate(); // Leaf aggregate = lift(key, value)
+	return N;
+}
+
+//-----------------------------------------------------------------------------
+// Release a node to another map or a handle: detached, uncharged and reset
+// to a leaf. A compacted node is first copied to a heap node of its own
+// (allocated before anything is unlinked), since only this map can free
+// its block slots.
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::release(Node* node) {
+	void* raw = (regions_.owns(node)) ? ::operator new(sizeof(Node)) : nullptr;
+	detach(node);
+	if (budget_) budget_->release(nodeCharge);
+	AVLMAP_STAT(++stats_.deallocations); // Gone from this map; a handle frees it uncounted
+
+	if (raw) {
+		Node* copy = new (raw) Node(std::move(node->key), std::move(node->value), nullptr, 0, 0, nullptr, nullptr);
+		regions_.destroy(node);
+		node = copy;
+	}
+	node->parent = nullptr;
+	node->left = nullptr;
+	node->right = nullptr;
+	node->height = 0;
+	node->balance = 0;
+	return node;
+}
+
+//-----------------------------------------------------------------------------
+// Free a node (every node deallocation goes through here, except nodes
+// handed out by release, which were counted when they left)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::destroyNode(Node* node) {
+	AVLMAP_STAT(++stats_.deallocations);
+	if (budget_) budget_->release(nodeCharge);
+	if constexpr (separateValues) {
+		slab_.release(node->value.address());
+	}
+	if (!regions_.destroy(node)) {
+		delete node;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Lowest ancestor of the hint whose subtree must contain key (if present).
+// Going up through a left child only raises the upper bound and through a
+// right child only lowers the lower bound, so we climb until the bound on
+// the side of key is passed. Cost grows with the distance to the hint.
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::fingerStart(Node* hint, KEY_TYPE const& key) const {
+	Node* N = hint;
+	if (!N) {
+		return pRoot; // No hint, plain search from the root
+	}
+
+	AVLMAP_STAT(++stats_.comparisons);
+	if (key < N->key) {
+		// Need an ancestor reached from its right child with a smaller key
+		while (N->parent) {
+			AVLMAP_STAT(++stats_.comparisons);
+			if (N == N->parent->right && N->parent->key < key) break;
+			N = N->parent;
+		}
+	}
+	else if (key > N->key) {
+		// Need an ancestor reached from its left child with a larger key
+		while (N->parent) {
+			AVLMAP_STAT(++stats_.comparisons);
+			if (N == N->parent->left && key < N->parent->key) break;
+			N = N->parent;
+		}
+	}
+	return N;
+}
+
+//-----------------------------------------------------------------------------
+// Search below `from`; returns the node holding key, or nullptr with parent
+// set to the node the key would hang from and left set to the side
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::descend(Node* from, KEY_TYPE const& key, Node*& parent, bool& left) const {
+	Node* N = from;
+	parent = nullptr;
+	left = false;
+	AVLMAP_STAT(++stats_.lookups);
+	while (N) {
+		AVLMAP_STAT(++stats_.comparisons);
+		parent = N;
+		if (key < N->key) {
+			left = true;
+			N = N->left;
+		}
+		else if (key > N->key) {
+			left = false;
+			N = N->right;
+		}
+		else {
+			return N;
+		}
+	}
+	return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Recompute aggregates from node up to the root
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::refreshAggregates(Node* node) {
+	if constexpr (AGGREGATE::enabled) {
+		for (; node; node = node->parent) {
+			node->updateAggregate();
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Refresh the paths of nodes handed out by operator[]. Until then only their
+// ancestors can be stale, which rotations and retraces preserve.
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::flushAggregates() {
+	if constexpr (AGGREGATE::enabled) {
+		for (Node* N : pendingAggregates_) {
+			N->pending = false;
+			refreshAggregates(N);
+		}
+		pendingAggregates_.clear();
+	}
+}
+
+/*!****************************************************************************
+// Class AVLmap Aggregate Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Reduce keys in [lo, hi] in key order, or fill result and return false if
+// the range is empty. O(log n): below the node where the searches for lo
+// and hi split, each step adds a whole subtree aggregate.
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+bool CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::reduce(KEY_TYPE const& lo, KEY_TYPE const& hi, typename AGGREGATE::value_type& result) {
+	static_assert(AGGREGATE::enabled, "reduce() needs an AGGREGATE policy");
+	typedef typename AGGREGATE::value_type agg_type;
+	flushAggregates();
+
+	// Find the highest node inside [lo, hi]
+	Node* split = pRoot;
+	while (split && (split->key < lo || hi < split->key)) {
+		split = (split->key < lo) ? split->right : split->left;
+	}
+	if (!split) return false;
+
+	agg_type total = AGGREGATE::lift(split->key, split->value.get());
+
+	// Left boundary: keys >= lo below split->left, collected right to left
+	for (Node* N = split->left; N; ) {
+		if (N->key < lo) {
+			N = N->right;
+		}
+		else {
+			agg_type part = AGGREGATE::lift(N->key, N->value.get());
+			if (N->right) part = AGGREGATE::combine(part, N->right->agg);
+			total = AGGREGATE::combine(part, total);
+			N = N->left;
+		}
+	}
+
+	// Right boundary: keys <= hi below split->right, collected left to right
+	for (Node* N = split->right; N; ) {
+		if (hi < N->key) {
+			N = N->left;
+		}
+		else {
+			agg_type part = AGGREGATE::lift(N->key, N->value.get());
+			if (N->left) part = AGGREGATE::combine(N->left->agg, part);
+			total = AGGREGATE::combine(total, part);
+			N = N->right;
+		}
+	}
+
+	result = total;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Reduce keys in [lo, hi]; an empty range gives a value initialized result
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename AGGREGATE::value_type CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::reduce(KEY_TYPE const& lo, KEY_TYPE const& hi) {
+	typename AGGREGATE::value_type result = typename AGGREGATE::value_type();
+	reduce(lo, hi, result);
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+// Build the next count pairs as a subtree whose halves differ by at most
+// one node (so it is AVL balanced); recursion depth is log2(count)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+template<typename ITER>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::buildSorted(ITER& it, std::size_t count, int depth, int redDepth) {
+	if (count == 0) return nullptr;
+
+	std::size_t leftCount = count / 2;
+	Node* left = buildSorted(it, leftCount, depth + 1, redDepth);
+	Node* N = allocateNode(it->first, it->second, nullptr); // assignSorted reserved the budget
+	++it;
+	Node* right = buildSorted(it, count - leftCount - 1, depth + 1, redDepth);
+	linkSorted(N, left, right, depth, redDepth);
+	return N;
+}
+
+//-----------------------------------------------------------------------------
+// Relink the next count nodes of a list (key order, chained on left) into a
+// perfectly balanced subtree, the same shape buildSorted gives; the root's
+// parent is left to the caller
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::relinkSorted(Node*& list, std::size_t count, int depth, int redDepth) {
+	if (count == 0) return nullptr;
+
+	std::size_t leftCount = count / 2;
+	Node* left = relinkSorted(list, leftCount, depth + 1, redDepth);
+	Node* N = list;
+	list = list->left;
+	Node* right = relinkSorted(list, count - leftCount - 1, depth + 1, redDepth);
+	linkSorted(N, left, right, depth, redDepth);
+	return N;
+}
+
+//-----------------------------------------------------------------------------
+// Hang left and right below N and set its height / rank / colour and
+// aggregate for a perfectly balanced tree
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::linkSorted(Node* N, Node* left, Node* right, int depth, int redDepth) {
+	N->left = left;
+	N->right = right;
+	if (left) left->parent = N;
+	if (right) right->parent = N;
+	N->height = N->getHeight(); // Also a valid RelaxedAVL rank
+	if constexpr (BALANCE::kind == BalanceKind::RedBlack) {
+		N->balance = (depth == redDepth) ? 1 : 0;
+	}
+	else {
+		N->balance = N->getBalanceFactor();
+	}
+	N->updateAggregate();
+}
+
+//-----------------------------------------------------------------------------
+// Only a partly filled bottom level is red, so every path has the same black
+// count; a full tree (or a lone root) is all black
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+int CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::sortedRedDepth(std::size_t count) {
+	if constexpr (BALANCE::kind == BalanceKind::RedBlack) {
+		int bottom = 0; // floor(log2(count))
+		for (std::size_t n = count; n > 1; n /= 2) ++bottom;
+		if (bottom > 0) return bottom;
+	}
+	return -1;
+}
+
+//-----------------------------------------------------------------------------
+// RelaxedAVL insert fix-up. Every rank difference must stay >= 1; a new leaf
+// (rank 0) under a rank 0 parent breaks that. Promote while the parent's
+// other child is a 1-child, then at most two rotations finish the job.
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::relaxedInsertFixup(Node* x) {
+#ifdef AVLMAP_ENABLE_STATS
+	unsigned long long steps = 0;
+	++stats_.retraces;
+#endif
+	Node* P = x->parent;
+	while (P && rankOf(P) == rankOf(x)) {
+		AVLMAP_STAT(++steps);
+		Node* sibling = (x == P->left) ? P->right : P->left;
+		if (rankOf(P) - rankOf(sibling) == 1) {
+			++P->height; // Promote
+			x = P;
+			P = P->parent;
+			continue;
+		}
+
+		if (x == P->left) {
+			Node* inner = x->right;
+			if (rankOf(x) - rankOf(inner) >= 2) {
+				rightRotate(P);
+				--P->height;
+			}
+			else {
+				leftRotate(x);
+				rightRotate(P);
+				++inner->height;
+				--x->height;
+				--P->height;
+			}
+		}
+		else {
+			Node* inner = x->left;
+			if (rankOf(x) - rankOf(inner) >= 2) {
+				leftRotate(P);
+				--P->height;
+			}
+			else {
+				rightRotate(x);
+				leftRotate(P);
+				++inner->height;
+				--x->height;
+				--P->height;
+			}
+		}
+		break;
+	}
+#ifdef AVLMAP_ENABLE_STATS
+	stats_.retraceSteps += steps;
+	if (steps > stats_.maxRetrace) stats_.maxRetrace = steps;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// RedBlack insert fix-up: recolour while the uncle is red, otherwise one
+// or two rotations. Missing children count as black.
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::redBlackInsertFixup(Node* x) {
+#ifdef AVLMAP_ENABLE_STATS
+	unsigned long long steps = 0;
+	++stats_.retraces;
+#endif
+	x->balance = 1;
+	while (isRed(x->parent)) {
+		AVLMAP_STAT(++steps);
+		Node* P = x->parent;
+		Node* G = P->parent; // A red node is never the root
+		if (P == G->left) {
+			Node* uncle = G->right;
+			if (isRed(uncle)) {
+				P->balance = 0;
+				uncle->balance = 0;
+				G->balance = 1;
+				x = G;
+				continue;
+			}
+			if (x == P->right) {
+				leftRotate(P);
+				P = x;
+			}
+			P->balance = 0;
+			G->balance = 1;
+			rightRotate(G);
+		}
+		else {
+			Node* uncle = G->left;
+			if (isRed(uncle)) {
+				P->balance = 0;
+				uncle->balance = 0;
+				G->balance = 1;
+				x = G;
+				continue;
+			}
+			if (x == P->left) {
+				rightRotate(P);
+				P = x;
+			}
+			P->balance = 0;
+			G->balance = 1;
+			leftRotate(G);
+		}
+		break;
+	}
+	if (!x->parent) x->balance = 0; // Recolouring reached the root
+#ifdef AVLMAP_ENABLE_STATS
+	stats_.retraceSteps += steps;
+	if (steps > stats_.maxRetrace) stats_.maxRetrace = steps;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// RedBlack erase fix-up. x replaced a removed black node and carries an
+// extra black; x may be null, so its parent is passed separately.
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::redBlackEraseFixup(Node* x, Node* parent) {
+	while (parent && !isRed(x)) {
+		if (x == parent->left) {
+			Node* W = parent->right; // Non null: its side has black height >= 1
+			if (isRed(W)) {
+				W->balance = 0;
+				parent->balance = 1;
+				leftRotate(parent);
+				W = parent->right;
+			}
+			if (!isRed(W->left) && !isRed(W->right)) {
+				W->balance = 1;
+				x = parent;
+				parent = x->parent;
+				continue;
+			}
+			if (!isRed(W->right)) {
+				W->left->balance = 0;
+				W->balance = 1;
+				rightRotate(W);
+				W = parent->right;
+			}
+			W->balance = parent->balance;
+			parent->balance = 0;
+			W->right->balance = 0;
+			leftRotate(parent);
+		}
+		else {
+			Node* W = parent->left;
+			if (isRed(W)) {
+				W->balance = 0;
+				parent->balance = 1;
+				rightRotate(parent);
+				W = parent->left;
+			}
+			if (!isRed(W->left) && !isRed(W->right)) {
+				W->balance = 1;
+				x = parent;
+				parent = x->parent;
+				continue;
+			}
+			if (!isRed(W->left)) {
+				W->right->balance = 0;
+				W->balance = 1;
+				leftRotate(W);
+				W = parent->left;
+			}
+			W->balance = parent->balance;
+			parent->balance = 0;
+			W->left->balance = 0;
+			rightRotate(parent);
+		}
+		return;
+	}
+	if (x) x->balance = 0;
+}
+
+//-----------------------------------------------------------------------------
+// RedBlack colour (missing children are black)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+bool CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::isRed(Node const* node) {
+	return node && node->balance == 1;
+}
+
+//-----------------------------------------------------------------------------
+// RelaxedAVL rank (missing children rank -1)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+int CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::rankOf(Node const* node) {
+	return node ? node->height : -1;
+}
+
+/*!****************************************************************************
+// Class AVLmap Diagnostics Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Validate BST order, parent links, size_ and the balance policy invariant
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+bool CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::validate(std::ostream* os) const {
+	if (pRoot && pRoot->parent) {
+		if (os) *os << "root has a parent" << std::endl;
+		return false;
+	}
+
+	// In-order walk with an explicit stack
+	std::stack<Node const*> pending;
+	Node const* N = pRoot;
+	Node const* prev = nullptr;
+	std::size_t count = 0;
+	while (N || !pending.empty()) {
+		while (N) {
+			pending.push(N);
+			N = N->left;
+		}
+		N = pending.top();
+		pending.pop();
+
+		if ((N->left && N->left->parent != N) || (N->right && N->right->parent != N)) {
+			if (os) *os << "broken parent link below in-order position " << count << std::endl;
+			return false;
+		}
+		if (prev && !(prev->key < N->key)) {
+			if (os) *os << "keys out of order at in-order position " << count << std::endl;
+			return false;
+		}
+		if constexpr (BALANCE::kind == BalanceKind::StrictAVL) {
+			if (N->height != N->getHeight()) {
+				if (os) *os << "stale height at in-order position " << count << std::endl;
+				return false;
+			}
+			if (N->balance != N->getBalanceFactor()) {
+				if (os) *os << "stale balance at in-order position " << count << std::endl;
+				return false;
+			}
+			if (N->balance > 1 || N->balance < -1) {
+				if (os) *os << "unbalanced at in-order position " << count << std::endl;
+				return false;
+			}
+		}
+		else if constexpr (BALANCE::kind == BalanceKind::RelaxedAVL) {
+			if (rankOf(N->left) >= N->height || rankOf(N->right) >= N->height) {
+				if (os) *os << "rank not above child's at in-order position " << count << std::endl;
+				return false;
+			}
+		}
+		else {
+			if (isRed(N) && (isRed(N->left) || isRed(N->right))) {
+				if (os) *os << "red node with a red child at in-order position " << count << std::endl;
+				return false;
+			}
+		}
+
+		++count;
+		prev = N;
+		N = N->right;
+	}
+
+	if (count != size_) {
+		if (os) *os << "size_ is " << size_ << " but tree holds " << count << std::endl;
+		return false;
+	}
+
+	if constexpr (BALANCE::kind == BalanceKind::RedBlack) {
+		if (isRed(pRoot)) {
+			if (os) *os << "red root" << std::endl;
+			return false;
+		}
+
+		// Every path from the root to a missing child passes the same number
+		// of black nodes
+		std::stack<std::pair<Node const*, int>> paths;
+		paths.push(std::make_pair(pRoot, 0));
+		int blackHeight = -1;
+		while (!paths.empty()) {
+			Node const* P = paths.top().first;
+			int blacks = paths.top().second;
+			paths.pop();
+			if (!P) {
+				if (blackHeight < 0) blackHeight = blacks;
+				if (blacks != blackHeight) {
+					if (os) *os << "unequal black heights " << blackHeight << " and " << blacks << std::endl;
+					return false;
+				}
+				continue;
+			}
+			blacks += (isRed(P)) ? 0 : 1;
+			paths.push(std::make_pair(P->left, blacks));
+			paths.push(std::make_pair(P->right, blacks));
+		}
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Height against the policy's bound and average node depth
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmapShape CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::shape_report() const {
+	AVLmapShape shape;
+	if (!pRoot) return shape;
+
+	// Depth-first walk carrying each node's depth
+	std::stack<std::pair<Node const*, std::size_t>> pending;
+	pending.push(std::make_pair(pRoot, std::size_t(0)));
+	std::size_t totalDepth = 0;
+	std::size_t maxDepth = 0;
+	while (!pending.empty()) {
+		Node const* N = pending.top().first;
+		std::size_t depth = pending.top().second;
+		pending.pop();
+
+		++shape.size;
+		totalDepth += depth;
+		if (depth > maxDepth) maxDepth = depth;
+		if (N->left)  pending.push(std::make_pair(N->left, depth + 1));
+		if (N->right) pending.push(std::make_pair(N->right, depth + 1));
+	}
+
+	// AVL: levels < 1.4405*log2(n+2) - 0.3277; red-black: levels <= 2*log2(n+1).
+	// A RelaxedAVL tree is bounded by its insert count, not n, so it can pass
+	// the AVL figure after many erases. Height counts edges.
+	shape.height = static_cast<int>(maxDepth);
+	if constexpr (BALANCE::kind == BalanceKind::RedBlack) {
+		shape.heightBound = 2.0 * std::log2(static_cast<double>(shape.size) + 1.0) - 1.0;
+	}
+	else {
+		shape.heightBound = 1.4405 * std::log2(static_cast<double>(shape.size) + 2.0) - 1.3277;
+	}
+	shape.averageDepth = static_cast<double>(totalDepth) / static_cast<double>(shape.size);
+	return shape;
+}
+
+/*!****************************************************************************
+// Class AVLmap Memory Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Memory Usage - O(1), owned bytes left at zero
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmapMemory CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::memory_usage() const {
+	AVLmapMemory usage;
+	usage.nodes = size_;
+	usage.nodeBytes = size_ * sizeof(Node);
+	std::size_t compacted = regions_.live();
+	usage.slackBytes = (size_ - compacted) * AVLmapMemory::allocationSlack(sizeof(Node)) +
+	                   (regions_.capacity() - compacted) * sizeof(Node) + // dead or unused slots
+	                   pendingAggregates_.capacity() * sizeof(Node*) +
+	                   compactPlan_.capacity() * sizeof(Node*);
+	if constexpr (separateValues) {
+		slab_.memory(size_, usage);
+	}
+	return usage;
+}
+
+//-----------------------------------------------------------------------------
+// Memory Usage - plus ownedBytes(key, value) summed over every entry, O(n)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+template<typename FN>
+CS280::AVLmapMemory CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::memory_usage(FN ownedBytes) const {
+	AVLmapMemory usage = memory_usage();
+	for (Node* N = (pRoot) ? pRoot->first() : nullptr; N; N = N->increment()) {
+		usage.ownedBytes += ownedBytes(N->key, N->value.get());
+	}
+	return usage;
+}
+
+//-----------------------------------------------------------------------------
+// Set Budget - the current nodes move their charge to the new budget (which
+// may end up over its limit; only later inserts are refused)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::setBudget(AVLmapBudget* budget) {
+	if (budget == budget_) return;
+	if (budget_) budget_->release(size_ * nodeCharge);
+	if (budget) budget->charge(size_ * nodeCharge);
+	budget_ = budget;
+}
+
+//-----------------------------------------------------------------------------
+// Get Budget
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmapBudget* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::getBudget() const {
+	return budget_;
+}
+
+/*!****************************************************************************
+// Class AVLmap Node Transfer Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Extract - unlink the entry and hand its node to the caller
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::node_type CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::extract(AVLmap_iterator it) {
+	node_type handle;
+	if (!it.p_node) return handle;
+
+	handle.node = release(it.p_node);
+	if constexpr (separateValues) {
+		// The slab belongs to this map, so the value travels in the handle
+		VALUE_TYPE* value = handle.node->value.address();
+		handle.detached.emplace(std::move(*value));
+		slab_.release(value);
+	}
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// Extract by key
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::node_type CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::extract(KEY_TYPE const& key) {
+	Node* P = nullptr;
+	bool left = false;
+	return extract(AVLmap_iterator(descend(pRoot, key, P, left)));
+}
+
+//-----------------------------------------------------------------------------
+// Insert a node handle - links the node itself; if the key is already here
+// the handle is handed back untouched. Over budget throws std::bad_alloc
+// and the handle keeps its node.
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::insert_return_type CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::insert(node_type&& handle) {
+	if (handle.empty()) {
+		return insert_return_type{ end(), false, node_type() };
+	}
+
+	Node* P = nullptr;
+	bool left = false;
+	Node* N = descend(pRoot, handle.node->key, P, left);
+	if (N) {
+		return insert_return_type{ AVLmap_iterator(N), false, std::move(handle) };
+	}
+
+	if (budget_ && !budget_->reserve(nodeCharge)) {
+		throw std::bad_alloc();
+	}
+	N = handle.node;
+	if constexpr (separateValues) {
+		try {
+			N->value = value_slot(slab_.acquire(std::move(*handle.detached)));
+		}
+		catch (...) {
+			if (budget_) budget_->release(nodeCharge);
+			throw;
+		}
+		handle.detached.reset();
+	}
+	handle.node = nullptr;
+
+	AVLMAP_STAT(++stats_.allocations); // Taken in from a handle
+	N->updateAggregate(); // Leaf aggregate
+	attach(P, left, N);
+	return insert_return_type{ AVLmap_iterator(N), true, node_type() };
+}
+
+//-----------------------------------------------------------------------------
+// Merge - walk other in key order and move over every node whose key is not
+// here; each search starts from the previous node (finger search). Nodes
+// whose keys are present stay in other.
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::merge(AVLmap& other) {
+	if (&other == this) return;
+
+	Node* hint = nullptr;
+	Node* N = (other.pRoot) ? other.pRoot->first() : nullptr;
+	while (N) {
+		Node* next = N->increment(); // Detaching relinks, so next stays valid
+		Node* P = nullptr;
+		bool left = false;
+		Node* found = descend(fingerStart(hint, N->key), N->key, P, left);
+		if (found) {
+			hint = found;
+			N = next;
+			continue;
+		}
+
+		if (budget_ && !budget_->reserve(nodeCharge)) {
+			throw std::bad_alloc();
+		}
+		if constexpr (separateValues) {
+			VALUE_TYPE* value = nullptr;
+			try {
+				value = slab_.acquire(std::move(N->value.get()));
+				try {
+					N = other.release(N);
+				}
+				catch (...) {
+					N->value.get() = std::move(*value); // Still in other: put the value back
+					slab_.release(value);
+					throw;
+				}
+			}
+			catch (...) {
+				if (budget_) budget_->release(nodeCharge);
+				throw;
+			}
+			other.slab_.release(N->value.address());
+			N->value = value_slot(value);
+		}
+		else {
+			try {
+				N = other.release(N);
+			}
+			catch (...) {
+				if (budget_) budget_->release(nodeCharge);
+				throw;
+			}
+		}
+
+		AVLMAP_STAT(++stats_.allocations); // Taken in from other
+		N->updateAggregate(); // Leaf aggregate
+		attach(P, left, N);
+		hint = N;
+		N = next;
+	}
+}
+
+/*!****************************************************************************
+// Class AVLmap Bulk Erase Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Erase [first, last) - returns last, which stays valid
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::AVLmap_iterator CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::erase(AVLmap_iterator first, AVLmap_iterator last) {
+	if (first == last) return last;
+	eraseSpan(first.p_node->key, (last.p_node) ? &last.p_node->key : nullptr, false);
+	return last;
+}
+
+//-----------------------------------------------------------------------------
+// Erase Range - keys in [lo, hi]
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::size_type CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::erase_range(KEY_TYPE const& lo, KEY_TYPE const& hi) {
+	if (hi < lo) return 0;
+	return eraseSpan(lo, &hi, true);
+}
+
+//-----------------------------------------------------------------------------
+// Erase If - pred runs over every entry before anything changes. Up to half
+// the entries are erased one by one; past that the survivors (now the
+// smaller part) are relinked into a perfectly balanced tree in O(n), which
+// also undoes the slack erases leave in RelaxedAVL ranks.
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+template<typename PRED>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::size_type CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::erase_if(PRED pred) {
+	std::vector<Node*> doomed; // Key order
+	for (Node* N = (pRoot) ? pRoot->first() : nullptr; N; N = N->increment()) {
+		if (pred(static_cast<KEY_TYPE const&>(N->key), static_cast<VALUE_TYPE const&>(N->Value()))) doomed.push_back(N);
+	}
+	if (doomed.empty()) return 0;
+
+	if (doomed.size() <= size_ / 2) {
+		for (Node* N : doomed) {
+			detach(N);
+			destroyNode(N);
+		}
+		return doomed.size();
+	}
+
+	flushAggregates(); // Pending nodes may be about to go away
+	abandonCompaction();
+
+	// Chain the survivors on left: an in-order walk never reads the left link
+	// of a node it has passed
+	Node* head = nullptr;
+	Node* tail = nullptr;
+	std::size_t next = 0;
+	for (Node* N = pRoot->first(); N; ) {
+		Node* following = N->increment();
+		if (next < doomed.size() && doomed[next] == N) {
+			++next;
+		}
+		else {
+			if (tail) {
+				tail->left = N;
+			}
+			else {
+				head = N;
+			}
+			tail = N;
+		}
+		N = following;
+	}
+	for (Node* N : doomed) {
+		destroyNode(N);
+	}
+
+	size_ -= doomed.size();
+	pRoot = relinkSorted(head, size_, 0, sortedRedDepth(size_));
+	if (pRoot) pRoot->parent = nullptr;
+	return doomed.size();
+}
+
+//-----------------------------------------------------------------------------
+// Erase keys from lo up to hi: split below lo, split again after hi, free the
+// middle and join the rest. A range with no keys leaves the tree untouched.
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::size_type CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::eraseSpan(KEY_TYPE const& lo, KEY_TYPE const* hi, bool hiInclusive) {
+	Node* lowest = nullptr; // First key >= lo
+	for (Node* N = pRoot; N; ) {
+		if (N->key < lo) {
+			N = N->right;
+		}
+		else {
+			lowest = N;
+			N = N->left;
+		}
+	}
+	if (!lowest) return 0;
+	if (hi && ((hiInclusive) ? *hi < lowest->key : !(lowest->key < *hi))) return 0;
+
+	flushAggregates(); // Pending nodes may be about to go away
+	abandonCompaction(); // Splits and joins rotate nodes the plan has placed
+	Node* below;
+	Node* rest;
+	Node* middle;
+	Node* above = nullptr;
+	split(pRoot, lo, false, below, rest);
+	if (hi) {
+		split(rest, *hi, hiInclusive, middle, above);
+	}
+	else {
+		middle = rest;
+	}
+	size_type count = destroySubtree(middle);
+	size_ -= count;
+
+	pRoot = join(below, above);
+	if constexpr (BALANCE::kind == BalanceKind::RedBlack) {
+		if (pRoot) pRoot->balance = 0; // A split can leave a red root
+	}
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// Split a detached tree into keys before key and the rest (keys equal to key
+// go left if keyLeft). Each level joins one side back with the node it cut.
+// A join costs O(1 + height difference) and the side it builds only grows
+// in height from level to level, so the differences telescope to the tree
+// height: the whole split is O(log n) (RedBlack pays O(log n) per join to
+// measure black heights, O(log^2 n) in all).
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::split(Node* root, KEY_TYPE const& key, bool keyLeft, Node*& left, Node*& right) {
+	if (!root) {
+		left = right = nullptr;
+		return;
+	}
+	Node* L = root->left;
+	Node* R = root->right;
+	if (L) L->parent = nullptr;
+	if (R) R->parent = nullptr;
+
+	bool goesLeft = (keyLeft) ? !(key < root->key) : root->key < key;
+	Node* rest;
+	if (goesLeft) {
+		split(R, key, keyLeft, rest, right);
+		left = join(L, root, rest);
+	}
+	else {
+		split(L, key, keyLeft, left, rest);
+		right = join(rest, root, R);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Join two detached trees and mid (every key in left < mid < every key in
+// right). When the heights are close mid becomes the root; otherwise mid
+// goes down the taller tree's inner spine to the first subtree C that
+// matches the shorter tree, takes C's place with C and the shorter tree as
+// children, and the policy's insert fix-up repairs the one spot that can be
+// off. The trees are detached, so everything above mid is the spine just
+// walked down: cost is O(1 + height difference) for every policy.
+//   StrictAVL  - C has height <= short + 1; retrace from mid's parent until
+//                a subtree's height is unchanged
+//   RelaxedAVL - C has rank <= short + 1; mid can only tie its parent's
+//                rank the way a promoted insert does
+//   RedBlack   - C is black with the short tree's black height; mid is red
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::join(Node* left, Node* mid, Node* right) {
+	mid->parent = nullptr;
+	int leftHeight;
+	int rightHeight;
+	if constexpr (BALANCE::kind == BalanceKind::RedBlack) {
+		if (left) left->balance = 0; // A detached root may be red
+		if (right) right->balance = 0;
+		leftHeight = blackHeight(left);
+		rightHeight = blackHeight(right);
+	}
+	else {
+		leftHeight = (left) ? left->height : -1; // Height or rank
+		rightHeight = (right) ? right->height : -1;
+	}
+
+	int gap = (BALANCE::kind == BalanceKind::RedBlack) ? 0 : 1;
+	if (leftHeight - rightHeight <= gap && rightHeight - leftHeight <= gap) {
+		mid->left = left;
+		mid->right = right;
+		if (left) left->parent = mid;
+		if (right) right->parent = mid;
+		mid->height = mid->getHeight();
+		if constexpr (BALANCE::kind == BalanceKind::RedBlack) {
+			mid->balance = 0;
+		}
+		else {
+			mid->balance = mid->getBalanceFactor();
+		}
+		mid->updateAggregate();
+		return mid;
+	}
+
+	// Down the inner spine of the taller tree
+	bool intoLeft = leftHeight > rightHeight;
+	Node* shorter = (intoLeft) ? right : left;
+	int target = (intoLeft) ? rightHeight : leftHeight;
+	int height = (intoLeft) ? leftHeight : rightHeight; // Black height of C (RedBlack)
+	Node* P = nullptr;
+	Node* C = (intoLeft) ? left : right;
+	for (;;) {
+		if constexpr (BALANCE::kind == BalanceKind::RedBlack) {
+			if (!C || (!isRed(C) && height == target)) break;
+			if (!isRed(C)) --height;
+		}
+		else {
+			if (!C || C->height <= target + 1) break;
+		}
+		P = C;
+		C = (intoLeft) ? C->right : C->left;
+	}
+
+	// mid takes C's place
+	if (intoLeft) {
+		mid->left = C;
+		mid->right = shorter;
+		P->right = mid;
+	}
+	else {
+		mid->left = shorter;
+		mid->right = C;
+		P->left = mid;
+	}
+	mid->parent = P;
+	if (C) C->parent = mid;
+	if (shorter) shorter->parent = mid;
+
+	if constexpr (BALANCE::kind == BalanceKind::StrictAVL) {
+		mid->height = mid->getHeight();
+		mid->balance = mid->getBalanceFactor();
+		mid->updateAggregate();
+
+		// Retrace up the spine just walked, stopping once a subtree is back
+		// to its old height. Unlike an insert, a rotation here may leave the
+		// subtree one taller (mid's child can be balanced), so keep going then.
+		Node* N = P;
+		while (N) {
+			int oldHeight = N->height;
+			N->height = N->getHeight();
+			N->balance = N->getBalanceFactor();
+			N->updateAggregate();
+			if (N->balance > 1) {
+				if (N->left->balance < 0) leftRotate(N->left);
+				N = rightRotate(N);
+			}
+			else if (N->balance < -1) {
+				if (N->right->balance > 0) rightRotate(N->right);
+				N = leftRotate(N);
+			}
+			if (N->height == oldHeight) break;
+			N = N->parent;
+		}
+		if (N) refreshAggregates(N->parent); // Contents below changed all the way up
+	}
+	else if constexpr (BALANCE::kind == BalanceKind::RelaxedAVL) {
+		mid->height = mid->getHeight();
+		mid->balance = mid->getBalanceFactor();
+		refreshAggregates(mid); // Rotations keep subtree contents, so before is fine
+		relaxedInsertFixup(mid);
+	}
+	else {
+		refreshAggregates(mid);
+		redBlackInsertFixup(mid);
+	}
+
+	Node* root = mid;
+	while (root->parent) root = root->parent;
+	return root;
+}
+
+//-----------------------------------------------------------------------------
+// Join two detached trees: the right tree's minimum becomes the middle node
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::join(Node* left, Node* right) {
+	if (!left) return right;
+	if (!right) return left;
+	Node* mid;
+	right = removeFirst(right, mid);
+	return join(left, mid, right);
+}
+
+//-----------------------------------------------------------------------------
+// Take the minimum out of a detached tree, rejoining each level on the way up
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::Node* CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::removeFirst(Node* root, Node*& first) {
+	Node* L = root->left;
+	Node* R = root->right;
+	if (R) R->parent = nullptr;
+	if (!L) {
+		first = root;
+		root->right = nullptr;
+		root->parent = nullptr;
+		return R;
+	}
+	L->parent = nullptr;
+	return join(removeFirst(L, first), root, R);
+}
+
+//-----------------------------------------------------------------------------
+// Free a detached subtree, children before parents
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+typename CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::size_type CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::destroySubtree(Node* root) {
+	size_type count = 0;
+	Node* N = root;
+	while (N) {
+		if (N->left) {
+			N = N->left;
+		}
+		else if (N->right) {
+			N = N->right;
+		}
+		else {
+			Node* P = (N == root) ? nullptr : N->parent;
+			if (P) {
+				if (P->left == N) {
+					P->left = nullptr;
+				}
+				else {
+					P->right = nullptr;
+				}
+			}
+			destroyNode(N);
+			++count;
+			N = P;
+		}
+	}
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// Black nodes from root down to a missing child (the same on every path)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+int CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::blackHeight(Node const* root) {
+	int height = 0;
+	for (; root; root = root->left) {
+		if (!isRed(root)) ++height;
+	}
+	return height;
+}
+
+/*!****************************************************************************
+// Class AVLmap Compaction Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Compact - relocate every node now (finishes a pass in progress)
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::compact(CompactOrder order) {
+	compact_step(std::numeric_limits<std::size_t>::max(), order);
+}
+
+//-----------------------------------------------------------------------------
+// Compact Step - the first call plans the pass and opens a block sized for
+// the whole tree; each call then relocates up to maxNodes nodes. The tree is
+// valid between steps, so lookups and inserts can run in the gaps.
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+bool CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::compact_step(std::size_t maxNodes, CompactOrder order) {
+	flushAggregates(); // The pending list holds node addresses
+	if (compactPlan_.empty()) {
+		if (!pRoot) return true;
+		compactPlan(order);
+		regions_.open(compactPlan_.size());
+		compactNext_ = 0;
+	}
+
+	std::size_t left = compactPlan_.size() - compactNext_;
+	std::size_t count = (maxNodes < left) ? maxNodes : left;
+	for (std::size_t i = 0; i < count; ++i) {
+		relocate(compactPlan_[compactNext_++]);
+	}
+
+	if (compactNext_ < compactPlan_.size()) return false;
+	abandonCompaction(); // Done: drop the plan and close the block
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Plan the pass: every node in target order
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::compactPlan(CompactOrder order) {
+	compactPlan_.reserve(size_);
+	if (order == CompactOrder::BreadthFirst) {
+		// The plan doubles as the queue
+		compactPlan_.push_back(pRoot);
+		for (std::size_t i = 0; i < compactPlan_.size(); ++i) {
+			Node* N = compactPlan_[i];
+			if (N->left)  compactPlan_.push_back(N->left);
+			if (N->right) compactPlan_.push_back(N->right);
+		}
+		return;
+	}
+
+	// Levels in the tree (heights are not depths under every BALANCE policy)
+	int levels = 0;
+	std::stack<std::pair<Node*, int>> pending;
+	pending.push(std::make_pair(pRoot, 1));
+	while (!pending.empty()) {
+		Node* N = pending.top().first;
+		int level = pending.top().second;
+		pending.pop();
+		if (level > levels) levels = level;
+		if (N->left)  pending.push(std::make_pair(N->left, level + 1));
+		if (N->right) pending.push(std::make_pair(N->right, level + 1));
+	}
+	layoutVEB(pRoot, levels);
+}
+
+//-----------------------------------------------------------------------------
+// van Emde Boas layout of node's subtree cut to levels: the top half of the
+// levels first, then each bottom subtree, each laid out the same way
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::layoutVEB(Node* node, int levels) {
+	if (!node) return;
+	if (levels == 1) {
+		compactPlan_.push_back(node);
+		return;
+	}
+	int top = levels / 2;
+	layoutVEB(node, top);
+	layoutBottoms(node, top, levels - top);
+}
+
+//-----------------------------------------------------------------------------
+// layoutVEB on each node depth levels below node, left to right
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::layoutBottoms(Node* node, int depth, int levels) {
+	if (!node) return;
+	if (depth == 0) {
+		layoutVEB(node, levels);
+		return;
+	}
+	layoutBottoms(node->left, depth - 1, levels);
+	layoutBottoms(node->right, depth - 1, levels);
+}
+
+//-----------------------------------------------------------------------------
+// Move one node into the next slot and point its neighbours at the copy
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::relocate(Node* node) {
+	Node* N = new (regions_.take()) Node(std::move(node->key), std::move(node->value), node->parent,
+	                                     node->height, node->balance, node->left, node->right);
+	static_cast<AggregateSlot<AGGREGATE>&>(*N) = static_cast<AggregateSlot<AGGREGATE> const&>(*node);
+
+	if (!N->parent) {
+		pRoot = N;
+	}
+	else if (N->parent->left == node) {
+		N->parent->left = N;
+	}
+	else {
+		N->parent->right = N;
+	}
+	if (N->left)  N->left->parent = N;
+	if (N->right) N->right->parent = N;
+
+	if (!regions_.destroy(node)) {
+		delete node;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Drop the pass in progress; moved nodes stay in their block
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::abandonCompaction() {
+	if (compactPlan_.empty()) return;
+	std::vector<Node*>().swap(compactPlan_);
+	compactNext_ = 0;
+	regions_.close();
+}
+
+#ifdef AVLMAP_ENABLE_STATS
+/*!****************************************************************************
+// Class AVLmap Statistics Methods
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Snapshot of the counters, with the depth histogram filled in
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+CS280::AVLmapStats CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::stats() const {
+	AVLmapStats snapshot = stats_;
+	snapshot.depthHistogram.clear();
+	for (Node* N = pRoot ? pRoot->first() : nullptr; N; N = N->increment()) {
+		std::size_t depth = static_cast<std::size_t>(getdepth(N));
+		if (depth >= snapshot.depthHistogram.size()) {
+			snapshot.depthHistogram.resize(depth + 1, 0);
+		}
+		++snapshot.depthHistogram[depth];
+	}
+	return snapshot;
+}
+
+//-----------------------------------------------------------------------------
+// Reset the counters
+//-----------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+void CS280::AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE>::resetStats() {
+	stats_.reset();
+}
+#endif
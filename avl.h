@@ -1,189 +1,662 @@
-/*!*****************************************************************************
-*\file     avl.h
-*\author   Jalin A. Brown
-*\brief Description:
-	Self balancing binary search tree (AVL tree) implementation.
-
-	API is exactly the same. You just add rebalancing.
-
-	Implement:
-	1) rotations - both left and right
-	2) balance calculation
-	3) AVL logic - this step will require modification of the BST insert and erase
-******************************************************************************/
-
-#ifndef AVLMAP_H
-#define AVLMAP_H
-
-//-----------------------------------------------------------------------------
-// Includes:
-//-----------------------------------------------------------------------------
-
-#include <utility> // std::move()
-#include <stack>	 // std::stack
-
-namespace CS280 {
-		//-----------------------------------------------------------------------------
-		// AVLmap class declarations
-		//-----------------------------------------------------------------------------
-    template< typename KEY_TYPE, typename VALUE_TYPE >
-    class AVLmap {
-		public:
-
-			//-----------------------------------------------------------------------------
-			// Node class declarations
-			//-----------------------------------------------------------------------------
-			class Node {
-				public:
-					// Big Four
-					Node( KEY_TYPE k, VALUE_TYPE val, Node* p, int h, int b, Node* l, Node* r);
-					Node(const Node&)               = delete;
-					Node* operator=(const Node&)    = delete;
-					
-					// Gettters
-          KEY_TYPE const & Key() const;   // return a const reference
-          VALUE_TYPE  &    Value();       // return a reference
-					Node*  first(); // minimum - follow left as far as possible
-					Node*  last(); // maximum - follow right as far as possible
-					Node*  increment(); // successor
-					Node*  decrement(); // predecessor
-
-					// Helper functions
-					void print(std::ostream& os ) const;
-					bool hasKey(KEY_TYPE const& k);
-					int  getHeight() const;
-					int  getBalanceFactor() const;
-					void updateHeight();
-					void setKey(const KEY_TYPE& newKey);
-					void setValue(const VALUE_TYPE& newValue);
-
-				private:
-          KEY_TYPE    key;
-					VALUE_TYPE  value;
-					Node        *parent;
-					Node        *left;
-					Node        *right;
-					int         height,balance; // optional
-
-					friend class AVLmap;
-			};
-
-		// AVLmap_iterator class declarations
-    private:
-
-			//-----------------------------------------------------------------------------
-			// AVLmap_iterator class declarations
-			//-----------------------------------------------------------------------------
-			class AVLmap_iterator {
-				private:
-					Node* p_node;
-				public:
-					AVLmap_iterator(Node* p=nullptr);
-					AVLmap_iterator(const AVLmap_iterator& rhs);
-					AVLmap_iterator& operator=(const AVLmap_iterator& rhs);
-					AVLmap_iterator& operator++();
-					AVLmap_iterator operator++(int);
-					Node & operator*();
-					Node * operator->();
-					Node* getnode() {return p_node;}
-					bool operator!=(const AVLmap_iterator& rhs);
-          bool operator==(const AVLmap_iterator& rhs);
-
-					friend class AVLmap;
-			};
-
-			//-----------------------------------------------------------------------------
-			// AVLmap_iterator_const class declarations
-			//-----------------------------------------------------------------------------
-			class AVLmap_iterator_const {
-				private:
-					Node* p_node;
-				public:
-					AVLmap_iterator_const(Node* p=nullptr);
-					AVLmap_iterator_const& operator=(const AVLmap_iterator_const& rhs);
-					AVLmap_iterator_const& operator++();
-					AVLmap_iterator_const operator++(int);
-					Node const& operator*();
-					Node const* operator->();
-					Node* getnode() { return p_node; }
-					bool operator!=(const AVLmap_iterator_const& rhs);
-					bool operator==(const AVLmap_iterator_const& rhs);
-
-					friend class AVLmap;
-			};
-
-		//-----------------------------------------------------------------------------
-		// AVLmap class implementations
-		//-----------------------------------------------------------------------------
-		Node* pRoot = nullptr;
-    unsigned int size_ = 0;
-		static AVLmap_iterator end_it;
-		static AVLmap_iterator_const const_end_it;
-
-		public:
-			// BIG FOUR
-			AVLmap();
-			AVLmap(const AVLmap& rhs);
-			AVLmap& operator=(const AVLmap& rhs);
-			virtual ~AVLmap();
-
-			// Operator[]
-			VALUE_TYPE& operator[](KEY_TYPE const& key);
-
-			// Move constructor and move assignment
-			AVLmap(AVLmap&& other) noexcept;
-			AVLmap& operator=(AVLmap&& other) noexcept;
-
-			// Getters
-      unsigned int size();
-			int getdepth(Node* b) const;
-
-			// Helper functions
-			void erase(AVLmap_iterator it);
-			void clear();
-			int getHeight(Node* node);
-			void insert(KEY_TYPE const& key, VALUE_TYPE const& value);
-			void copyTree(Node* dest, const Node* src);// Method to copy a subtree recursively
-
-			//standard names for iterator types
-			typedef AVLmap_iterator       iterator;
-			typedef AVLmap_iterator_const const_iterator;
-
-			//-----------------------------------------------------------------------------
-			// AVLmap methods dealing with non-const iterator 
-			//-----------------------------------------------------------------------------
-			AVLmap_iterator begin();
-			AVLmap_iterator end();
-			AVLmap_iterator find(KEY_TYPE const& key);
-
-			//-----------------------------------------------------------------------------
-			// AVLmap methods dealing with const iterator 
-			//-----------------------------------------------------------------------------
-			AVLmap_iterator_const begin() const;
-			AVLmap_iterator_const end() const;
-			AVLmap_iterator_const find(KEY_TYPE const& key) const;
-
-			//-----------------------------------------------------------------------------
-			// AVLmap Rotation Methods
-			//-----------------------------------------------------------------------------
-
-			Node* leftRotate(Node* y); // Left Rotation			
-			Node* rightRotate(Node* y); // Right Rotation
-			void updateBalanceAfterInsert(Node* node);
-			void updateBalanceAfterDelete(Node* node);
-			void updateBalance(Node* node);
-			void updateHeights(Node* node);
-
-			friend class AVLmap_iterator;
-			friend class AVLmap_iterator_const;
-		private:
-	};
-
-	// Operator<<
-  template< typename KEY_TYPE, typename VALUE_TYPE >
-	std::ostream& operator<<(std::ostream& os, AVLmap<KEY_TYPE, VALUE_TYPE> const& map);
-
-}
-
-#include "avl-map.cpp"
-#endif
+/*!*****************************************************************************
+*\file     avl.h
+*\author   Jalin A. Brown
+*\brief Description:
+	Self balancing binary search tree (AVL tree) implementation.
+
+	API is exactly the same. You just add rebalancing.
+
+	Implement:
+	1) rotations - both left and right
+	2) balance calculation
+	3) AVL logic - this step will require modification of the BST insert and erase
+******************************************************************************/
+
+#ifndef AVLMAP_H
+#define AVLMAP_H
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include <utility> // std::move()
+#include <stack>	 // std::stack
+#include <vector>	 // std::vector
+#include <ostream> // std::ostream
+#include <cstddef> // std::size_t
+#include <type_traits> // std::conditional, std::integral_constant
+#include <limits>  // std::numeric_limits
+#include <atomic>  // std::atomic
+#include <functional> // std::function
+#include <memory>  // std::allocator
+#include <optional> // std::optional
+
+//-----------------------------------------------------------------------------
+// Statistics (compile with AVLMAP_ENABLE_STATS to turn them on; when the
+// macro is not defined every AVLMAP_STAT() expands to nothing)
+//-----------------------------------------------------------------------------
+#ifdef AVLMAP_ENABLE_STATS
+#define AVLMAP_STAT(expr) (expr)
+#else
+#define AVLMAP_STAT(expr) ((void)0)
+#endif
+
+namespace CS280 {
+		//-----------------------------------------------------------------------------
+		// AVLmapStats struct declarations
+		//-----------------------------------------------------------------------------
+		struct AVLmapStats {
+			unsigned long long lookups        = 0; // find / operator[] / insert descents
+			unsigned long long comparisons    = 0; // nodes compared against during descents
+			unsigned long long leftRotations  = 0;
+			unsigned long long rightRotations = 0;
+			unsigned long long retraces       = 0; // insert fix-ups under every BALANCE policy, one per linked node
+			unsigned long long retraceSteps   = 0; // fix-up loop steps: StrictAVL / RelaxedAVL levels climbed, RedBlack recolourings
+			unsigned long long maxRetrace     = 0; // longest single retrace
+			unsigned long long allocations    = 0; // nodes created, or taken in by insert(node_type&&) / merge
+			unsigned long long deallocations  = 0; // nodes destroyed, or handed out by extract / merge
+			std::vector<unsigned long long> depthHistogram; // depthHistogram[d] = nodes at depth d
+
+			void reset();
+			void print(std::ostream& os) const;
+		};
+
+		//-----------------------------------------------------------------------------
+		// AVLmapShape struct declarations
+		//-----------------------------------------------------------------------------
+		struct AVLmapShape {
+			std::size_t size         = 0;
+			int         height       = -1;  // root height, leaf = 0, empty = -1
+			double      heightBound  = 0.0; // worst case height for size (AVL ~1.44*log2(n), red-black 2*log2(n))
+			double      averageDepth = 0.0; // mean node depth, root = 0
+
+			void print(std::ostream& os) const;
+		};
+
+		//-----------------------------------------------------------------------------
+		// AVLmapMemory struct declarations - what a map costs, in bytes. Slack is
+		// an estimate: allocator headers and rounding (16 byte granules plus one
+		// word per allocation), unused slab slots and spare vector capacity.
+		//-----------------------------------------------------------------------------
+		struct AVLmapMemory {
+			std::size_t nodes      = 0;
+			std::size_t nodeBytes  = 0; // nodes * sizeof(Node)
+			std::size_t valueBytes = 0; // slab slots in use (separate values only)
+			std::size_t slackBytes = 0;
+			std::size_t ownedBytes = 0; // heap owned by keys / values, from the caller's hook
+
+			std::size_t total() const;
+			void print(std::ostream& os) const;
+			static std::size_t allocationSlack(std::size_t bytes); // estimated overhead of one allocation
+		};
+
+		//-----------------------------------------------------------------------------
+		// AVLmapBudget class declarations - a byte limit that one or more maps
+		// charge their nodes against (thread safe, so shards or tenants can share
+		// one). When a reservation would pass the limit the callback runs; it may
+		// free memory elsewhere or raise the limit and return true to retry, or
+		// return false to fail the insert with std::bad_alloc. The callback must
+		// not modify the map that is inserting.
+		//-----------------------------------------------------------------------------
+		class AVLmapBudget {
+			public:
+				typedef std::function<bool(std::size_t requested, AVLmapBudget& budget)> callback_type;
+
+				explicit AVLmapBudget(std::size_t limit, callback_type onExceeded = nullptr);
+				AVLmapBudget(const AVLmapBudget&)            = delete;
+				AVLmapBudget& operator=(const AVLmapBudget&) = delete;
+
+				bool reserve(std::size_t bytes); // false if over the limit after the callback
+				void charge(std::size_t bytes);  // unconditional
+				void release(std::size_t bytes);
+
+				std::size_t used() const;
+				std::size_t limit() const;
+				void setLimit(std::size_t limit);
+				void setCallback(callback_type onExceeded); // not thread safe against reserve()
+
+			private:
+				std::atomic<std::size_t> usedBytes{0};
+				std::atomic<std::size_t> limitBytes;
+				callback_type exceeded;
+		};
+
+		//-----------------------------------------------------------------------------
+		// Value layout policies (LAYOUT template parameter of AVLmap)
+		//   InlineValues   - value stored inside the node next to the key
+		//   SeparateValues - node keeps a pointer into a per-map value slab, so
+		//                    descents only touch keys and links
+		//   AutoValues<N>  - separate when sizeof(VALUE_TYPE) > N bytes
+		//-----------------------------------------------------------------------------
+		struct InlineValues {
+			template<typename VALUE_TYPE> struct separate : std::false_type {};
+		};
+
+		struct SeparateValues {
+			template<typename VALUE_TYPE> struct separate : std::true_type {};
+		};
+
+		template<std::size_t MAX_INLINE = 64>
+		struct AutoValues {
+			template<typename VALUE_TYPE> struct separate : std::integral_constant<bool, (sizeof(VALUE_TYPE) > MAX_INLINE)> {};
+		};
+
+		//-----------------------------------------------------------------------------
+		// ValueSlot class declarations - what a node holds for its value
+		//-----------------------------------------------------------------------------
+		template<typename VALUE_TYPE, bool SEPARATE>
+		class ValueSlot {
+			public:
+				explicit ValueSlot(VALUE_TYPE val) : value(std::move(val)) {}
+				VALUE_TYPE&       get()       { return value; }
+				VALUE_TYPE const& get() const { return value; }
+			private:
+				VALUE_TYPE value;
+		};
+
+		template<typename VALUE_TYPE>
+		class ValueSlot<VALUE_TYPE, true> {
+			public:
+				explicit ValueSlot(VALUE_TYPE* p) : pValue(p) {}
+				VALUE_TYPE&       get()       { return *pValue; }
+				VALUE_TYPE const& get() const { return *pValue; }
+				VALUE_TYPE* address() const { return pValue; }
+			private:
+				VALUE_TYPE* pValue;
+		};
+
+		//-----------------------------------------------------------------------------
+		// ValueSlab class declarations - chunked value storage with a free list,
+		// addresses stay stable for the lifetime of the value
+		//-----------------------------------------------------------------------------
+		template<typename VALUE_TYPE>
+		class ValueSlab {
+			public:
+				ValueSlab() = default;
+				ValueSlab(const ValueSlab&)            = delete;
+				ValueSlab& operator=(const ValueSlab&) = delete;
+				ValueSlab(ValueSlab&& other) noexcept;
+				ValueSlab& operator=(ValueSlab&& other) noexcept;
+				~ValueSlab();
+
+				VALUE_TYPE* acquire(VALUE_TYPE value);
+				void release(VALUE_TYPE* value);
+				void memory(std::size_t live, AVLmapMemory& usage) const; // adds value and slack bytes
+
+			private:
+				union Slot {
+					Slot* next;
+					alignas(VALUE_TYPE) unsigned char storage[sizeof(VALUE_TYPE)];
+				};
+
+				std::vector<Slot*> chunks;   // every chunk ever allocated
+				Slot*       freeList  = nullptr;
+				std::size_t nextChunk = 16;  // slots in the next chunk (doubles up to 4096)
+				std::size_t slots     = 0;   // slots across all chunks
+		};
+
+		// Stand-in for ValueSlab when values are stored inline
+		struct NoValueSlab {};
+
+		//-----------------------------------------------------------------------------
+		// NodeRegions class declarations - contiguous blocks that compact() moves
+		// nodes into. Slots are handed out in order and never reused; a block is
+		// freed when its last node is destroyed.
+		//-----------------------------------------------------------------------------
+		template<typename NODE>
+		class NodeRegions {
+			public:
+				NodeRegions() = default;
+				NodeRegions(const NodeRegions&)            = delete;
+				NodeRegions& operator=(const NodeRegions&) = delete;
+				NodeRegions(NodeRegions&& other) noexcept;
+				NodeRegions& operator=(NodeRegions&& other) noexcept;
+				~NodeRegions();
+
+				void  open(std::size_t nodes); // start a block for the next nodes take() calls
+				void* take();                  // next slot of the open block
+				void  close();                 // done taking; an unused block is freed
+				bool  destroy(NODE* node);     // false if node is not in a block
+				bool  owns(NODE const* node) const;
+				std::size_t live() const;      // nodes in blocks
+				std::size_t capacity() const;  // slots in blocks
+
+			private:
+				struct Block {
+					NODE*       storage;
+					std::size_t capacity;
+					std::size_t used;
+					std::size_t live;
+				};
+
+				void free(std::size_t index);
+
+				std::vector<Block> blocks;
+				bool filling = false; // the last block is open
+		};
+
+		//-----------------------------------------------------------------------------
+		// Node orders for AVLmap::compact()
+		//   VanEmdeBoas  - recursive top half / bottom halves split: any cache line
+		//                  or page size holds whole subtrees, so a root to leaf
+		//                  path touches O(log_B n) blocks without knowing B
+		//   BreadthFirst - level by level: the hot top levels share a few pages
+		//-----------------------------------------------------------------------------
+		enum class CompactOrder { VanEmdeBoas, BreadthFirst };
+
+		//-----------------------------------------------------------------------------
+		// Aggregate policies (AGGREGATE template parameter of AVLmap)
+		// Each node caches combine(left subtree, lift(key, value), right subtree)
+		// so AVLmap::reduce(lo, hi) runs in O(log n). A policy provides:
+		//   enabled, value_type, lift(key, value), combine(a, b)
+		// combine must be associative; it need not be commutative.
+		//-----------------------------------------------------------------------------
+		struct NoAggregate {
+			static constexpr bool enabled = false;
+			struct value_type {};
+		};
+
+		template<typename VALUE_TYPE>
+		struct SumAggregate {
+			static constexpr bool enabled = true;
+			typedef VALUE_TYPE value_type;
+			template<typename KEY_TYPE>
+			static value_type lift(KEY_TYPE const&, VALUE_TYPE const& v) { return v; }
+			static value_type combine(value_type const& a, value_type const& b) { return a + b; }
+		};
+
+		template<typename VALUE_TYPE>
+		struct MinAggregate {
+			static constexpr bool enabled = true;
+			typedef VALUE_TYPE value_type;
+			template<typename KEY_TYPE>
+			static value_type lift(KEY_TYPE const&, VALUE_TYPE const& v) { return v; }
+			static value_type combine(value_type const& a, value_type const& b) { return (b < a) ? b : a; }
+		};
+
+		template<typename VALUE_TYPE>
+		struct MaxAggregate {
+			static constexpr bool enabled = true;
+			typedef VALUE_TYPE value_type;
+			template<typename KEY_TYPE>
+			static value_type lift(KEY_TYPE const&, VALUE_TYPE const& v) { return v; }
+			static value_type combine(value_type const& a, value_type const& b) { return (a < b) ? b : a; }
+		};
+
+		//-----------------------------------------------------------------------------
+		// AggregateSlot - node base holding the cached aggregate (empty when the
+		// policy is disabled, so NoAggregate nodes do not grow)
+		//-----------------------------------------------------------------------------
+		template<typename AGGREGATE, bool ENABLED = AGGREGATE::enabled>
+		struct AggregateSlot {
+			typename AGGREGATE::value_type agg;
+			bool pending = false; // queued for refresh after an operator[] access
+		};
+
+		template<typename AGGREGATE>
+		struct AggregateSlot<AGGREGATE, false> {};
+
+		//-----------------------------------------------------------------------------
+		// Balancing policies (BALANCE template parameter of AVLmap). All three share
+		// the node, iterators and API; they differ in what a node's height and
+		// balance fields mean and in the insert / erase fix-ups.
+		//   StrictAVL  - |balance| <= 1 everywhere, rotations on insert and erase;
+		//                shallowest trees, best for read heavy maps
+		//   RelaxedAVL - rank balanced, deletion without rebalancing: inserts
+		//                promote / rotate on ranks (height holds the rank), erase
+		//                only unlinks, so it never rotates. Height stays within
+		//                ~1.44*log2 of the inserts since the tree was built
+		//   RedBlack   - balance holds the colour; at most 2 rotations per insert
+		//                and 3 per erase, height <= 2*log2(n + 1)
+		//-----------------------------------------------------------------------------
+		enum class BalanceKind { StrictAVL, RelaxedAVL, RedBlack };
+
+		struct StrictAVL {
+			static constexpr BalanceKind kind = BalanceKind::StrictAVL;
+		};
+
+		struct RelaxedAVL {
+			static constexpr BalanceKind kind = BalanceKind::RelaxedAVL;
+		};
+
+		struct RedBlack {
+			static constexpr BalanceKind kind = BalanceKind::RedBlack;
+		};
+
+		//-----------------------------------------------------------------------------
+		// AVLmap class declarations
+		//-----------------------------------------------------------------------------
+    template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT = AutoValues<>, typename AGGREGATE = NoAggregate, typename BALANCE = StrictAVL>
+    class AVLmap {
+		public:
+			// true when values live in slab_ rather than in the node
+			static constexpr bool separateValues = LAYOUT::template separate<VALUE_TYPE>::value;
+			typedef ValueSlot<VALUE_TYPE, separateValues> value_slot;
+
+			//-----------------------------------------------------------------------------
+			// Node class declarations
+			//-----------------------------------------------------------------------------
+			class Node : private AggregateSlot<AGGREGATE> {
+				public:
+					// Big Four
+					Node( KEY_TYPE k, value_slot val, Node* p, int h, int b, Node* l, Node* r);
+					Node(const Node&)               = delete;
+					Node* operator=(const Node&)    = delete;
+					
+					// Gettters
+          KEY_TYPE const & Key() const;   // return a const reference
+          VALUE_TYPE  &    Value();       // return a reference
+					Node*  Left() const;   // children and parent, for walks outside AVLmap
+					Node*  Right() const;
+					Node*  Parent() const;
+					Node*  first(); // minimum - follow left as far as possible
+					Node*  last(); // maximum - follow right as far as possible
+					Node*  increment(); // successor
+					Node*  decrement(); // predecessor
+
+					// Helper functions
+					void print(std::ostream& os ) const;
+					bool hasKey(KEY_TYPE const& k);
+					int  getHeight() const;
+					int  getBalanceFactor() const;
+					void updateHeight();
+					void setKey(const KEY_TYPE& newKey);
+					void setValue(const VALUE_TYPE& newValue); // also refreshes aggregates up to the root
+					typename AGGREGATE::value_type const& Aggregate() const; // subtree aggregate
+					void updateAggregate(); // recompute from children
+
+				private:
+          KEY_TYPE    key;
+					value_slot  value;
+					Node        *parent;
+					Node        *left;
+					Node        *right;
+					int         height,balance; // StrictAVL: height, balance factor; RelaxedAVL: rank, unused; RedBlack: unused, colour (1 = red)
+
+					friend class AVLmap;
+			};
+
+		// AVLmap_iterator class declarations
+    private:
+
+			//-----------------------------------------------------------------------------
+			// AVLmap_iterator class declarations
+			//-----------------------------------------------------------------------------
+			class AVLmap_iterator {
+				private:
+					Node* p_node;
+				public:
+					AVLmap_iterator(Node* p=nullptr);
+					AVLmap_iterator(const AVLmap_iterator& rhs);
+					AVLmap_iterator& operator=(const AVLmap_iterator& rhs);
+					AVLmap_iterator& operator++();
+					AVLmap_iterator operator++(int);
+					Node & operator*();
+					Node * operator->();
+					Node* getnode() {return p_node;}
+					bool operator!=(const AVLmap_iterator& rhs);
+          bool operator==(const AVLmap_iterator& rhs);
+
+					friend class AVLmap;
+			};
+
+			//-----------------------------------------------------------------------------
+			// AVLmap_iterator_const class declarations
+			//-----------------------------------------------------------------------------
+			class AVLmap_iterator_const {
+				private:
+					Node* p_node;
+				public:
+					AVLmap_iterator_const(Node* p=nullptr);
+					AVLmap_iterator_const(const AVLmap_iterator_const& rhs);
+					AVLmap_iterator_const& operator=(const AVLmap_iterator_const& rhs);
+					AVLmap_iterator_const& operator++();
+					AVLmap_iterator_const operator++(int);
+					Node const& operator*();
+					Node const* operator->();
+					Node* getnode() { return p_node; }
+					bool operator!=(const AVLmap_iterator_const& rhs);
+					bool operator==(const AVLmap_iterator_const& rhs);
+
+					friend class AVLmap;
+			};
+
+		//-----------------------------------------------------------------------------
+		// AVLmap class implementations
+		//-----------------------------------------------------------------------------
+		Node* pRoot = nullptr;
+    std::size_t size_ = 0;
+		static AVLmap_iterator end_it;
+		static AVLmap_iterator_const const_end_it;
+
+		public:
+			typedef std::size_t size_type; // 64 bit on LP64 / LLP64 targets
+
+			// BIG FOUR
+			AVLmap();
+			AVLmap(const AVLmap& rhs);
+			AVLmap& operator=(const AVLmap& rhs);
+			virtual ~AVLmap();
+
+			// Operator[]
+			VALUE_TYPE& operator[](KEY_TYPE const& key);
+
+			// Move constructor and move assignment
+			AVLmap(AVLmap&& other) noexcept;
+			AVLmap& operator=(AVLmap&& other) noexcept;
+
+			// Getters
+      size_type size() const;
+			int getdepth(Node* b) const;
+			Node* getRoot() const;
+#ifdef AVLMAP_ENABLE_STATS
+			AVLmapStats stats() const; // counters plus a depth histogram built with getdepth()
+			void resetStats();
+#endif
+
+			// Helper functions
+			void erase(AVLmap_iterator it);
+			void clear();
+			int getHeight(Node* node);
+			void insert(KEY_TYPE const& key, VALUE_TYPE const& value);
+			void copyTree(Node* dest, const Node* src);// Method to copy a subtree recursively
+			template<typename ITER>
+			void assignSorted(ITER first, ITER last); // replace contents with strictly ascending (key, value) pairs, O(n)
+
+			//standard names for iterator types
+			typedef AVLmap_iterator       iterator;
+			typedef AVLmap_iterator_const const_iterator;
+
+			//-----------------------------------------------------------------------------
+			// AVLmap_node_handle class declarations - owns a node taken out of a map
+			// by extract(); insert() links it into a map of the same type without
+			// allocating or copying. With SeparateValues the value waits in the
+			// handle while out of a map (moved, not copied, between slabs).
+			//-----------------------------------------------------------------------------
+			class AVLmap_node_handle {
+				public:
+					AVLmap_node_handle() = default;
+					AVLmap_node_handle(const AVLmap_node_handle&)            = delete;
+					AVLmap_node_handle& operator=(const AVLmap_node_handle&) = delete;
+					AVLmap_node_handle(AVLmap_node_handle&& other) noexcept;
+					AVLmap_node_handle& operator=(AVLmap_node_handle&& other) noexcept;
+					~AVLmap_node_handle();
+
+					bool empty() const;
+					explicit operator bool() const;
+					KEY_TYPE const& key() const;
+					VALUE_TYPE& value();
+
+				private:
+					Node* node = nullptr;
+					typename std::conditional<separateValues, std::optional<VALUE_TYPE>, NoValueSlab>::type detached;
+
+					friend class AVLmap;
+			};
+			typedef AVLmap_node_handle node_type;
+
+			struct insert_return_type {
+				AVLmap_iterator position; // the inserted node, or the one holding the key
+				bool            inserted;
+				node_type       node;     // the handle back when the key was present
+			};
+
+			//-----------------------------------------------------------------------------
+			// AVLmap node transfer - entries move between maps by relinking their
+			// nodes: no allocation and no key / value copies (compacted nodes are
+			// first moved to a heap node of their own). Budgets are charged and
+			// released as nodes come and go, and so are the allocation counters, so
+			// allocations - deallocations stays the size of each map (from empty).
+			//-----------------------------------------------------------------------------
+			node_type extract(AVLmap_iterator it);
+			node_type extract(KEY_TYPE const& key); // empty handle if key is missing
+			insert_return_type insert(node_type&& handle);
+			void merge(AVLmap& other); // moves the nodes whose keys are not here yet
+
+			//-----------------------------------------------------------------------------
+			// AVLmap bulk erase - a range is cut out by splitting the tree at both
+			// ends, freeing the middle and joining the outer parts: O(log n) of
+			// rebalancing plus O(k) frees for k entries (RedBlack counts black
+			// heights on the way, O(log^2 n)). erase_if() relinks the survivors into
+			// a balanced tree in O(n) when more than half the entries go, and erases
+			// one by one otherwise. Iterators to the surviving entries stay valid.
+			//-----------------------------------------------------------------------------
+			AVLmap_iterator erase(AVLmap_iterator first, AVLmap_iterator last); // [first, last), returns last
+			size_type erase_range(KEY_TYPE const& lo, KEY_TYPE const& hi);     // keys in [lo, hi], returns the count
+			template<typename PRED>
+			size_type erase_if(PRED pred); // pred(key, value), returns the count; map unchanged if pred throws
+
+			//-----------------------------------------------------------------------------
+			// AVLmap methods dealing with non-const iterator 
+			//-----------------------------------------------------------------------------
+			AVLmap_iterator begin();
+			AVLmap_iterator end();
+			AVLmap_iterator find(KEY_TYPE const& key);
+
+			//-----------------------------------------------------------------------------
+			// AVLmap finger (hinted) methods - the search starts at the hint and only
+			// climbs parent links until the key is inside the subtree, so keys close
+			// to the hint are reached without a walk from pRoot. end() = no hint.
+			//-----------------------------------------------------------------------------
+			AVLmap_iterator find_near(AVLmap_iterator hint, KEY_TYPE const& key);
+			AVLmap_iterator insert(AVLmap_iterator hint, KEY_TYPE const& key, VALUE_TYPE const& value); // overwrites like insert()
+			template<typename... ARGS>
+			AVLmap_iterator emplace_hint(AVLmap_iterator hint, KEY_TYPE const& key, ARGS&&... args); // keeps an existing value
+
+			//-----------------------------------------------------------------------------
+			// AVLmap methods dealing with const iterator 
+			//-----------------------------------------------------------------------------
+			AVLmap_iterator_const begin() const;
+			AVLmap_iterator_const end() const;
+			AVLmap_iterator_const find(KEY_TYPE const& key) const;
+
+			//-----------------------------------------------------------------------------
+			// AVLmap Diagnostics (iterative, O(n), safe on deep trees)
+			//-----------------------------------------------------------------------------
+			bool validate(std::ostream* os = nullptr) const; // reports first violation to os
+			AVLmapShape shape_report() const;
+
+			//-----------------------------------------------------------------------------
+			// AVLmap Memory
+			// memory_usage() is O(1); with a hook, fn(key, value) returns the heap
+			// bytes an entry owns and every node is visited. With a budget set each
+			// node charges sizeof(Node) (plus its slab slot) and inserts that would
+			// pass the limit throw std::bad_alloc, leaving the map unchanged.
+			//-----------------------------------------------------------------------------
+			AVLmapMemory memory_usage() const;
+			template<typename FN>
+			AVLmapMemory memory_usage(FN ownedBytes) const;
+			void setBudget(AVLmapBudget* budget); // moves the current charge; nullptr = unlimited
+			AVLmapBudget* getBudget() const;
+
+			//-----------------------------------------------------------------------------
+			// AVLmap Compaction
+			// Copies nodes into one contiguous block in the given order and frees
+			// the old ones, restoring locality lost to churn. compact_step() moves
+			// at most maxNodes per call and returns true once the pass is done;
+			// inserts may run between steps, an erase abandons the pass (nodes
+			// already moved stay put). Relocation invalidates iterators and Node
+			// pointers; values kept in the slab do not move.
+			//-----------------------------------------------------------------------------
+			void compact(CompactOrder order = CompactOrder::VanEmdeBoas);
+			bool compact_step(std::size_t maxNodes, CompactOrder order = CompactOrder::VanEmdeBoas);
+
+			//-----------------------------------------------------------------------------
+			// AVLmap Aggregates (AGGREGATE policy must be enabled)
+			// Values written through operator[] references are picked up by the
+			// next reduce() or erase; use setValue() for writes via iterators.
+			//-----------------------------------------------------------------------------
+			typename AGGREGATE::value_type reduce(KEY_TYPE const& lo, KEY_TYPE const& hi); // keys in [lo, hi]
+			bool reduce(KEY_TYPE const& lo, KEY_TYPE const& hi, typename AGGREGATE::value_type& result); // false if range empty
+
+			friend class AVLmap_iterator;
+			friend class AVLmap_iterator_const;
+		private:
+			//-----------------------------------------------------------------------------
+			// AVLmap Rotation Methods (private: only the BALANCE policy's own fix-ups
+			// may restructure the tree, a StrictAVL retrace would corrupt the others)
+			//-----------------------------------------------------------------------------
+			Node* leftRotate(Node* y); // Left Rotation
+			Node* rightRotate(Node* y); // Right Rotation
+			void updateBalanceAfterInsert(Node* node);
+			void updateBalanceAfterDelete(Node* node);
+			void updateBalance(Node* node);  // StrictAVL bookkeeping, recomputed from the leaves
+			void updateHeights(Node* node);
+
+			Node* createNode(KEY_TYPE const& key, VALUE_TYPE value, Node* parent); // charges the budget
+			Node* allocateNode(KEY_TYPE const& key, VALUE_TYPE value, Node* parent); // caller has charged
+			Node* fingerStart(Node* hint, KEY_TYPE const& key) const;
+			Node* descend(Node* from, KEY_TYPE const& key, Node*& parent, bool& left) const;
+			void attach(Node* P, bool left, Node* newNode);
+			void detach(Node* node); // unlink and rebalance, the node is not freed
+			Node* release(Node* node); // detach for another map: uncharged, heap allocated, reset to a leaf
+			template<typename ITER>
+			Node* buildSorted(ITER& it, std::size_t count, int depth, int redDepth); // perfectly balanced subtree of the next count pairs
+			Node* relinkSorted(Node*& list, std::size_t count, int depth, int redDepth); // same, from a list of nodes chained on left
+			void linkSorted(Node* node, Node* left, Node* right, int depth, int redDepth);
+			static int sortedRedDepth(std::size_t count); // RedBlack: the partly filled bottom level, -1 if none
+			void relaxedInsertFixup(Node* node);               // RelaxedAVL promotions / rotations
+			void redBlackInsertFixup(Node* node);              // RedBlack recolouring / rotations
+			void redBlackEraseFixup(Node* node, Node* parent); // node (maybe nullptr) is one black short
+			static bool isRed(Node const* node);
+			static int  rankOf(Node const* node); // RelaxedAVL rank, -1 for a missing child
+			void refreshAggregates(Node* node);
+			void flushAggregates();
+			void destroyNode(Node* node);
+			size_type destroySubtree(Node* root); // post-order, returns the count
+			void copyFrom(const AVLmap& rhs);     // into an empty map; on a throw nothing is left or reserved
+			Node* join(Node* left, Node* mid, Node* right); // detached trees, left < mid < right; returns the root
+			Node* join(Node* left, Node* right);            // same, without a middle node
+			Node* removeFirst(Node* root, Node*& first);    // detached tree without its minimum
+			void split(Node* root, KEY_TYPE const& key, bool keyLeft, Node*& left, Node*& right); // keys equal to key go left if keyLeft
+			size_type eraseSpan(KEY_TYPE const& lo, KEY_TYPE const* hi, bool hiInclusive); // hi nullptr = to the end
+			static int blackHeight(Node const* root); // RedBlack: black nodes on the left spine
+			void compactPlan(CompactOrder order);
+			void layoutVEB(Node* node, int levels);             // subtree cut to levels, top half first
+			void layoutBottoms(Node* node, int depth, int levels); // layoutVEB on the nodes depth below
+			void relocate(Node* node);
+			void abandonCompaction();
+
+			typename std::conditional<separateValues, ValueSlab<VALUE_TYPE>, NoValueSlab>::type slab_;
+			NodeRegions<Node> regions_;      // compacted nodes; the rest come from new
+			std::vector<Node*> compactPlan_; // nodes of the pass in progress, in target order
+			std::size_t compactNext_ = 0;
+			std::vector<Node*> pendingAggregates_; // nodes handed out by operator[]
+			AVLmapBudget* budget_ = nullptr;
+
+			// Budget charge per node
+			static constexpr std::size_t nodeCharge = sizeof(Node) + (separateValues ? sizeof(VALUE_TYPE) : 0);
+
+#ifdef AVLMAP_ENABLE_STATS
+			mutable AVLmapStats stats_;
+#endif
+	};
+
+	// Operator<<
+  template<typename KEY_TYPE, typename VALUE_TYPE, typename LAYOUT, typename AGGREGATE, typename BALANCE>
+	std::ostream& operator<<(std::ostream& os, AVLmap<KEY_TYPE, VALUE_TYPE, LAYOUT, AGGREGATE, BALANCE> const& map);
+
+}
+
+#include "avl.cpp"
+#endif
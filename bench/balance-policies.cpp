@@ -0,0 +1,91 @@
+/*!*****************************************************************************
+*\file     balance-policies.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	StrictAVL, RelaxedAVL and RedBlack on the same read / write mixes: a map
+	of random int keys takes random operations with 90%, 50% and 10% finds,
+	the rest split between inserts and erases. Reports time per operation
+	and the shape left behind (height, mean depth). Built with
+	-DAVLMAP_ENABLE_STATS it also reports rotations per operation and
+	comparisons per descent (finds and inserts); the counters slow every
+	operation, so compare times from a build without them.
+
+	Build and run from the repository root:
+		g++ -O2 -std=c++17 -I. bench/balance-policies.cpp -o balance-policies
+		./balance-policies [keys] [operations]
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl.h"
+#include <chrono>  // std::chrono::steady_clock
+#include <cstdio>  // std::printf
+#include <cstdlib> // std::strtoul
+#include <random>  // std::mt19937
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+
+	//-----------------------------------------------------------------------------
+	// One policy at one read percentage
+	//-----------------------------------------------------------------------------
+	template<typename BALANCE>
+	void run(char const* name, unsigned readPercent, int count, long ops) {
+		CS280::AVLmap<int, int, CS280::AutoValues<>, CS280::NoAggregate, BALANCE> map;
+		std::mt19937 rng(1);
+		for (int i = 0; i < count; ++i) {
+			map.insert(static_cast<int>(rng() % (2 * count)), i);
+		}
+#ifdef AVLMAP_ENABLE_STATS
+		map.resetStats();
+#endif
+
+		long hits = 0;
+		clock_type::time_point start = clock_type::now();
+		for (long i = 0; i < ops; ++i) {
+			int      key = static_cast<int>(rng() % (2 * count));
+			unsigned r   = rng() % 100;
+			if (r < readPercent) {
+				hits += (map.find(key) != map.end());
+			}
+			else if (r & 1) {
+				map.insert(key, static_cast<int>(i));
+			}
+			else {
+				auto it = map.find(key);
+				if (it != map.end()) map.erase(it);
+			}
+		}
+		double ns = std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / ops;
+		CS280::AVLmapShape shape = map.shape_report();
+
+		std::printf("%5u%% %-10s %10.0f %8d %10.2f", readPercent, name, (hits > 0) ? ns : -1.0, shape.height, shape.averageDepth);
+#ifdef AVLMAP_ENABLE_STATS
+		CS280::AVLmapStats stats = map.stats();
+		std::printf(" %10.3f %12.2f", static_cast<double>(stats.leftRotations + stats.rightRotations) / ops,
+			static_cast<double>(stats.comparisons) / stats.lookups);
+#endif
+		std::printf("\n");
+	}
+}
+
+int main(int argc, char** argv) {
+	int  count = (argc > 1) ? static_cast<int>(std::strtoul(argv[1], nullptr, 10)) : 200000;
+	long ops   = (argc > 2) ? static_cast<long>(std::strtoul(argv[2], nullptr, 10)) : 2000000;
+
+	std::printf("%d keys, %ld random operations\n", count, ops);
+	std::printf("%6s %-10s %10s %8s %10s", "reads", "policy", "ns/op", "height", "mean depth");
+#ifdef AVLMAP_ENABLE_STATS
+	std::printf(" %10s %12s", "rot/op", "cmp/descent");
+#endif
+	std::printf("\n");
+	unsigned const mixes[] = { 90, 50, 10 };
+	for (unsigned readPercent : mixes) {
+		run<CS280::StrictAVL>("strict", readPercent, count, ops);
+		run<CS280::RelaxedAVL>("relaxed", readPercent, count, ops);
+		run<CS280::RedBlack>("red-black", readPercent, count, ops);
+	}
+	return 0;
+}
@@ -0,0 +1,99 @@
+/*!*****************************************************************************
+*\file     buffered-ingest.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	BufferedAVLmap against a plain AVLmap on insert heavy workloads:
+	1) sustained ingest - random int keys inserted back to back, final
+	   flush included, in millions of inserts a second
+	2) read-your-writes - each insert is followed at once by a find of the
+	   same key, in nanoseconds per insert + find pair (flushes included)
+
+	Build and run from the repository root:
+		g++ -O2 -std=c++17 -I. bench/buffered-ingest.cpp -o buffered-ingest
+		./buffered-ingest [keys]
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl-buffered.h"
+#include <chrono>  // std::chrono::steady_clock
+#include <cstdio>  // std::printf
+#include <cstdlib> // std::strtoul
+#include <random>  // std::mt19937
+#include <vector>  // std::vector
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+
+	double secondsSince(clock_type::time_point start) {
+		return std::chrono::duration<double>(clock_type::now() - start).count();
+	}
+
+	//-----------------------------------------------------------------------------
+	// Millions of inserts a second; bufferEntries 0 = plain AVLmap
+	//-----------------------------------------------------------------------------
+	double ingest(std::vector<int> const& keys, std::size_t bufferEntries) {
+		clock_type::time_point start = clock_type::now();
+		if (bufferEntries == 0) {
+			CS280::AVLmap<int, int> map;
+			for (std::size_t i = 0; i < keys.size(); ++i) {
+				map.insert(keys[i], static_cast<int>(i));
+			}
+		}
+		else {
+			CS280::BufferedAVLmap<int, int> map(bufferEntries);
+			for (std::size_t i = 0; i < keys.size(); ++i) {
+				map.insert(keys[i], static_cast<int>(i));
+			}
+			map.flush();
+		}
+		return keys.size() / secondsSince(start) / 1e6;
+	}
+
+	//-----------------------------------------------------------------------------
+	// Nanoseconds per insert + find of the same key; bufferEntries 0 = plain
+	//-----------------------------------------------------------------------------
+	double readYourWrites(std::vector<int> const& keys, std::size_t bufferEntries) {
+		long hits = 0;
+		clock_type::time_point start = clock_type::now();
+		if (bufferEntries == 0) {
+			CS280::AVLmap<int, int> map;
+			for (std::size_t i = 0; i < keys.size(); ++i) {
+				map.insert(keys[i], static_cast<int>(i));
+				hits += (map.find(keys[i]) != map.end());
+			}
+		}
+		else {
+			CS280::BufferedAVLmap<int, int> map(bufferEntries);
+			for (std::size_t i = 0; i < keys.size(); ++i) {
+				map.insert(keys[i], static_cast<int>(i));
+				hits += (map.find(keys[i]) != nullptr);
+			}
+		}
+		double ns = secondsSince(start) * 1e9 / keys.size();
+		return (hits == static_cast<long>(keys.size())) ? ns : -1.0; // -1: a write was not readable
+	}
+}
+
+int main(int argc, char** argv) {
+	std::size_t count = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+
+	std::mt19937 rng(1);
+	std::vector<int> keys(count);
+	for (int& key : keys) {
+		key = static_cast<int>(rng() % (2 * count));
+	}
+
+	std::printf("%zu random int keys\n", count);
+	std::printf("%-12s %16s %22s\n", "buffer", "ingest (M/s)", "read-your-writes (ns)");
+	std::size_t const sizes[] = { 0, 256, 1024, 4096 };
+	for (std::size_t bufferEntries : sizes) {
+		char name[32];
+		if (bufferEntries == 0) std::snprintf(name, sizeof(name), "plain");
+		else                    std::snprintf(name, sizeof(name), "%zu", bufferEntries);
+		std::printf("%-12s %16.2f %22.0f\n", name, ingest(keys, bufferEntries), readYourWrites(keys, bufferEntries));
+	}
+	return 0;
+}
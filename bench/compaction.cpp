@@ -0,0 +1,111 @@
+/*!*****************************************************************************
+*\file     compaction.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	Lookup time before and after compact(): random finds on a map built by
+	random inserts, again after rounds of insert / erase churn have
+	scattered its nodes over the heap, and after compacting the churned map
+	in BreadthFirst and then VanEmdeBoas order. Also times a whole pass of
+	compact_step() calls, the incremental form a server would spread over
+	idle time.
+
+	Build and run from the repository root:
+		g++ -O2 -std=c++17 -I. bench/compaction.cpp -o compaction
+		./compaction [keys] [churn rounds] [nodes per step]
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl.h"
+#include <chrono>  // std::chrono::steady_clock
+#include <cstdio>  // std::printf
+#include <cstdlib> // std::strtoul
+#include <random>  // std::mt19937_64
+#include <vector>  // std::vector
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+	typedef CS280::AVLmap<long, long> map_type;
+
+	double msSince(clock_type::time_point start) {
+		return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+	}
+
+	//-----------------------------------------------------------------------------
+	// Nanoseconds per find
+	//-----------------------------------------------------------------------------
+	double findTime(map_type& map, std::vector<long> const& queries) {
+		long hits = 0;
+		clock_type::time_point start = clock_type::now();
+		for (long key : queries) {
+			hits += (map.find(key) != map.end());
+		}
+		double ns = msSince(start) * 1e6 / queries.size();
+		return (hits > 0) ? ns : -1.0; // hits keep the finds from being optimised away
+	}
+
+	void row(char const* state, double compactMs, map_type& map, std::vector<long> const& queries) {
+		if (compactMs < 0) {
+			std::printf("%-24s %10zu %12s %10.0f\n", state, map.size(), "-", findTime(map, queries));
+		}
+		else {
+			std::printf("%-24s %10zu %12.1f %10.0f\n", state, map.size(), compactMs, findTime(map, queries));
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	long        count  = (argc > 1) ? static_cast<long>(std::strtoul(argv[1], nullptr, 10)) : 2000000;
+	std::size_t rounds = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 6;
+	std::size_t step   = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 10000;
+
+	std::mt19937_64 rng(5);
+	map_type map;
+	for (long i = 0; i < count; ++i) {
+		map.insert(static_cast<long>(rng() % (4 * count)), i);
+	}
+	std::vector<long> queries(count);
+	for (long& key : queries) {
+		key = static_cast<long>(rng() % (4 * count));
+	}
+
+	std::printf("%ld random finds (ns per find)\n", count);
+	std::printf("%-24s %10s %12s %10s\n", "state", "size", "compact ms", "find");
+	row("fresh", -1, map, queries);
+
+	// Alternate insert and erase of random keys: the map grows while its
+	// nodes end up in whatever free blocks the allocator hands back
+	for (std::size_t r = 0; r < rounds; ++r) {
+		for (long i = 0; i < count; ++i) {
+			long key = static_cast<long>(rng() % (4 * count));
+			if (i & 1) {
+				map.insert(key, i);
+			}
+			else {
+				map_type::iterator it = map.find(key);
+				if (it != map.end()) map.erase(it);
+			}
+		}
+	}
+	row("churned", -1, map, queries);
+
+	clock_type::time_point start = clock_type::now();
+	map.compact(CS280::CompactOrder::BreadthFirst);
+	row("compact(BreadthFirst)", msSince(start), map, queries);
+
+	start = clock_type::now();
+	map.compact(CS280::CompactOrder::VanEmdeBoas);
+	row("compact(VanEmdeBoas)", msSince(start), map, queries);
+
+	std::size_t steps = 1;
+	start = clock_type::now();
+	while (!map.compact_step(step)) {
+		++steps;
+	}
+	double total = msSince(start);
+	row("compact_step pass", total, map, queries);
+	std::printf("%zu steps of %zu nodes, %.2f ms per step\n", steps, step, total / steps);
+	return 0;
+}
@@ -0,0 +1,97 @@
+/*!*****************************************************************************
+*\file     durable-writes.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	DurableAVLmap write throughput under each SyncPolicy, plus the time to
+	recover the same map (checkpoint bulk load and log replay).
+
+	Random int keys are inserted with 4 KB group commits. Each policy gets
+	a fresh directory under the one given (default /tmp), removed again
+	afterwards. Point it at the file system the maps will live on: fsync
+	cost is what separates the policies.
+
+	Build and run from the repository root:
+		g++ -O2 -std=c++17 -I. bench/durable-writes.cpp -o durable-writes
+		./durable-writes [inserts] [directory]
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl-durable.h"
+#include <chrono>   // std::chrono::steady_clock
+#include <cstdio>   // std::printf, std::remove
+#include <cstdlib>  // std::strtoul
+#include <random>   // std::mt19937
+#include <string>   // std::string, std::to_string
+#include <unistd.h> // getpid, rmdir
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+
+	double secondsSince(clock_type::time_point start) {
+		return std::chrono::duration<double>(clock_type::now() - start).count();
+	}
+
+	void removeMap(std::string const& directory) {
+		std::remove((directory + "/wal").c_str());
+		std::remove((directory + "/checkpoint").c_str());
+		std::remove((directory + "/checkpoint.tmp").c_str());
+		::rmdir(directory.c_str());
+	}
+
+	//-----------------------------------------------------------------------------
+	// One policy: inserts a second, then recovery time in ms
+	//-----------------------------------------------------------------------------
+	bool run(char const* name, CS280::SyncPolicy sync, std::size_t inserts, std::string const& root) {
+		std::string directory = root + "/avl-durable-bench-" + std::to_string(::getpid()) + "-" + name;
+		removeMap(directory);
+
+		CS280::DurableOptions options;
+		options.sync = sync;
+		options.groupCommitBytes = 4096;
+		options.syncInterval = std::chrono::milliseconds(10);
+
+		double rate;
+		{
+			CS280::DurableAVLmap<int, int> map(options);
+			if (!map.open(directory)) return false;
+			std::mt19937 rng(1);
+			clock_type::time_point start = clock_type::now();
+			for (std::size_t i = 0; i < inserts; ++i) {
+				if (!map.insert(static_cast<int>(rng() % (2 * inserts)), static_cast<int>(i))) return false;
+			}
+			if (!map.commit()) return false;
+			rate = inserts / secondsSince(start) / 1e6;
+		}
+
+		clock_type::time_point start = clock_type::now();
+		std::size_t recovered;
+		{
+			CS280::DurableAVLmap<int, int> map(options);
+			if (!map.open(directory)) return false;
+			recovered = map.size();
+		}
+		double recovery = secondsSince(start) * 1e3;
+		removeMap(directory);
+
+		std::printf("%-10s %14.2f %14.1f %12zu\n", name, rate, recovery, recovered);
+		return true;
+	}
+}
+
+int main(int argc, char** argv) {
+	std::size_t inserts = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 200000;
+	std::string root    = (argc > 2) ? argv[2] : "/tmp";
+
+	std::printf("%zu random int inserts, 4 KB group commits, under %s\n", inserts, root.c_str());
+	std::printf("%-10s %14s %14s %12s\n", "policy", "M inserts/s", "recovery ms", "entries");
+	if (!run("Never", CS280::SyncPolicy::Never, inserts, root) ||
+	    !run("OnCommit", CS280::SyncPolicy::OnCommit, inserts, root) ||
+	    !run("Periodic", CS280::SyncPolicy::Periodic, inserts, root)) {
+		std::printf("I/O error under %s\n", root.c_str());
+		return 1;
+	}
+	return 0;
+}
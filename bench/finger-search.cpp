@@ -0,0 +1,125 @@
+/*!*****************************************************************************
+*\file     finger-search.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	Finger search against root searches on key streams with locality:
+	1) sequential - every key of the map in ascending order
+	2) clustered  - short random walks (steps of up to +-16 keys) around
+	   random starting points
+	3) random     - no locality, where the hint can only cost time
+	find() is compared with find_near() hinted by the previous result, and
+	insert() with insert(hint, ...) hinted by the previous insert (the
+	inserted keys fall between the keys already in the map).
+
+	Build and run from the repository root:
+		g++ -O2 -std=c++17 -I. bench/finger-search.cpp -o finger-search
+		./finger-search [keys]
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl.h"
+#include <chrono>  // std::chrono::steady_clock
+#include <cstdio>  // std::printf
+#include <cstdlib> // std::strtoul
+#include <random>  // std::mt19937
+#include <vector>  // std::vector
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+	typedef CS280::AVLmap<long, long> map_type;
+
+	double nsPer(clock_type::time_point start, std::size_t ops) {
+		return std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / ops;
+	}
+
+	//-----------------------------------------------------------------------------
+	// Key streams over the map's keys 0, 2, 4, ... 2 * (count - 1)
+	//-----------------------------------------------------------------------------
+	std::vector<long> stream(char const* kind, std::size_t count) {
+		std::vector<long> keys;
+		std::mt19937 rng(9);
+		long last = static_cast<long>(count) - 1;
+		if (kind[0] == 's') {
+			for (long i = 0; i <= last; ++i) keys.push_back(2 * i);
+		}
+		else if (kind[0] == 'c') {
+			while (keys.size() < count) {
+				long i = static_cast<long>(rng() % count);
+				for (int step = 0; step < 64; ++step) {
+					i += static_cast<long>(rng() % 33) - 16;
+					i = (i < 0) ? 0 : (i > last) ? last : i;
+					keys.push_back(2 * i);
+				}
+			}
+			keys.resize(count);
+		}
+		else {
+			for (std::size_t n = 0; n < count; ++n) keys.push_back(2 * static_cast<long>(rng() % count));
+		}
+		return keys;
+	}
+
+	//-----------------------------------------------------------------------------
+	// One stream: finds and inserts, plain against hinted
+	//-----------------------------------------------------------------------------
+	void run(char const* kind, map_type const& filled, std::size_t count) {
+		std::vector<long> keys = stream(kind, count);
+		map_type map(filled);
+		long hits = 0;
+
+		clock_type::time_point start = clock_type::now();
+		for (long key : keys) {
+			hits += (map.find(key) != map.end());
+		}
+		double find = nsPer(start, keys.size());
+
+		start = clock_type::now();
+		map_type::iterator hint = map.end();
+		for (long key : keys) {
+			map_type::iterator it = map.find_near(hint, key);
+			hits += (it != map.end());
+			hint = it;
+		}
+		double findNear = nsPer(start, keys.size());
+
+		// Odd keys go between the existing ones; each run starts from the full map
+		map_type plain(filled);
+		start = clock_type::now();
+		for (long key : keys) {
+			plain.insert(key + 1, key);
+		}
+		double insert = nsPer(start, keys.size());
+
+		map_type hinted(filled);
+		start = clock_type::now();
+		hint = hinted.end();
+		for (long key : keys) {
+			hint = hinted.insert(hint, key + 1, key);
+		}
+		double insertHint = nsPer(start, keys.size());
+
+		bool same = hits == 2 * static_cast<long>(keys.size()) && plain.size() == hinted.size();
+		std::printf("%-12s %10.0f %10.0f %10.0f %10.0f%s\n", kind, find, findNear, insert, insertHint, (same) ? "" : "  MISMATCH");
+	}
+}
+
+int main(int argc, char** argv) {
+	std::size_t count = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+
+	std::vector<std::pair<long, long>> sorted;
+	for (std::size_t i = 0; i < count; ++i) {
+		sorted.emplace_back(2 * static_cast<long>(i), static_cast<long>(i));
+	}
+	map_type filled;
+	filled.assignSorted(sorted.begin(), sorted.end());
+
+	std::printf("%zu keys (ns per operation)\n", count);
+	std::printf("%-12s %10s %10s %10s %10s\n", "stream", "find", "find_near", "insert", "hinted");
+	run("sequential", filled, count);
+	run("clustered", filled, count);
+	run("random", filled, count);
+	return 0;
+}
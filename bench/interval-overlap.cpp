@@ -0,0 +1,99 @@
+/*!*****************************************************************************
+*\file     interval-overlap.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	IntervalMap overlap queries against a linear scan of the same intervals
+	held in a std::vector. Intervals start uniformly over the point range
+	and are up to 1000 points long; query windows of growing width change
+	how many results k each query returns. overlaps() (any result) and
+	for_each_overlap() (every result) are timed on the map, and one pass
+	over the vector answers both.
+
+	Build and run from the repository root:
+		g++ -O2 -std=c++17 -I. bench/interval-overlap.cpp -o interval-overlap
+		./interval-overlap [intervals] [queries]
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl-interval.h"
+#include <chrono>  // std::chrono::steady_clock
+#include <cstdio>  // std::printf
+#include <cstdlib> // std::strtoul
+#include <random>  // std::mt19937
+#include <vector>  // std::vector
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+	typedef CS280::IntervalMap<long, int> map_type;
+
+	double nsPer(clock_type::time_point start, std::size_t ops) {
+		return std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / ops;
+	}
+
+	//-----------------------------------------------------------------------------
+	// One query width: mean results, then ns per query for each method
+	//-----------------------------------------------------------------------------
+	void run(map_type& map, std::vector<map_type::interval_type> const& all, long range, long width, std::size_t queries) {
+		std::mt19937 rng(3);
+		std::vector<long> lows(queries);
+		for (long& low : lows) {
+			low = static_cast<long>(rng() % range);
+		}
+
+		long found = 0;
+		clock_type::time_point start = clock_type::now();
+		for (long low : lows) {
+			found += map.overlaps(low, low + width);
+		}
+		double any = nsPer(start, queries);
+
+		long results = 0;
+		start = clock_type::now();
+		for (long low : lows) {
+			map.for_each_overlap(low, low + width, [&results](map_type::interval_type const&, int&) { ++results; });
+		}
+		double every = nsPer(start, queries);
+
+		long scanned = 0;
+		start = clock_type::now();
+		for (long low : lows) {
+			long high = low + width;
+			for (map_type::interval_type const& interval : all) {
+				scanned += !(high < interval.low) && !(interval.high < low);
+			}
+		}
+		double scan = nsPer(start, queries);
+
+		std::printf("%10ld %10.1f %12.0f %14.0f %12.0f%s\n", width, static_cast<double>(results) / queries, any, every, scan,
+			(scanned == results && found <= results) ? "" : "  MISMATCH");
+	}
+}
+
+int main(int argc, char** argv) {
+	std::size_t count   = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 200000;
+	std::size_t queries = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 2000;
+
+	long range = 1000 * static_cast<long>(count);
+	std::mt19937 rng(7);
+	map_type map;
+	std::vector<map_type::interval_type> all;
+	for (std::size_t i = 0; i < count; ++i) {
+		long low  = static_cast<long>(rng() % range);
+		long high = low + static_cast<long>(rng() % 1000);
+		map.insert(low, high, static_cast<int>(i));
+	}
+	for (map_type::map_type::iterator it = map.map().begin(); it != map.map().end(); ++it) {
+		all.push_back(it->Key());
+	}
+
+	std::printf("%zu intervals over %ld points, %zu queries (ns per query)\n", map.size(), range, queries);
+	std::printf("%10s %10s %12s %14s %12s\n", "width", "mean k", "overlaps", "for_each", "scan");
+	long const widths[] = { 0, 1000, 100000, 10000000, range / 10 };
+	for (long width : widths) {
+		run(map, all, range, width, queries);
+	}
+	return 0;
+}
@@ -0,0 +1,76 @@
+/*!*****************************************************************************
+*\file     parallel-walks.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	Parallel walks against the serial iterator loop over one large map:
+	a sum of the values (parallel_transform_reduce) and the entries whose
+	key is a multiple of 16 (parallel_collect_if), at 1 to 32 threads.
+
+	Build and run from the repository root:
+		g++ -O2 -std=c++17 -pthread -I. bench/parallel-walks.cpp -o parallel-walks
+		./parallel-walks [entries]
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl-parallel.h"
+#include <chrono>  // std::chrono::steady_clock
+#include <cstdio>  // std::printf
+#include <cstdlib> // std::strtoul
+#include <random>  // std::mt19937_64
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+	typedef CS280::AVLmap<long, long> map_type;
+
+	double msSince(clock_type::time_point start) {
+		return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+	}
+}
+
+int main(int argc, char** argv) {
+	std::size_t count = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 4000000;
+
+	map_type map;
+	std::mt19937_64 rng(3);
+	for (std::size_t i = 0; i < count; ++i) {
+		map.insert(static_cast<long>(rng() >> 1), static_cast<long>(i));
+	}
+
+	// Serial baselines through AVLmap_iterator::operator++
+	clock_type::time_point start = clock_type::now();
+	long sum = 0;
+	for (map_type::iterator it = map.begin(); it != map.end(); ++it) {
+		sum += it->Value();
+	}
+	double serialSum = msSince(start);
+
+	start = clock_type::now();
+	std::vector<std::pair<long, long>> matches;
+	for (map_type::iterator it = map.begin(); it != map.end(); ++it) {
+		if ((it->Key() & 15) == 0) matches.emplace_back(it->Key(), it->Value());
+	}
+	double serialCollect = msSince(start);
+
+	std::printf("%zu entries, %u hardware threads (ms)\n", map.size(), std::thread::hardware_concurrency());
+	std::printf("%8s %12s %12s\n", "threads", "sum", "collect_if");
+	std::printf("%8s %12.1f %12.1f\n", "serial", serialSum, serialCollect);
+	for (unsigned threads = 1; threads <= 32; threads *= 2) {
+		start = clock_type::now();
+		long parallelSum = CS280::parallel_transform_reduce(map, 0L,
+			[](long a, long b) { return a + b; },
+			[](long const&, long const& value) { return value; }, threads);
+		double sumMs = msSince(start);
+
+		start = clock_type::now();
+		std::vector<std::pair<long, long>> found = CS280::parallel_collect_if(map,
+			[](long const& key, long const&) { return (key & 15) == 0; }, threads);
+		double collectMs = msSince(start);
+
+		bool same = parallelSum == sum && found == matches;
+		std::printf("%8u %12.1f %12.1f%s\n", threads, sumMs, collectMs, (same) ? "" : "  MISMATCH");
+	}
+	return 0;
+}
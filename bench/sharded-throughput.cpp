@@ -0,0 +1,86 @@
+/*!*****************************************************************************
+*\file     sharded-throughput.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	Throughput of ShardedAVLmap against one AVLmap behind one lock (a map
+	with a single shard) at 1, 2, 4, 8, 16 and 32 threads.
+
+	Every thread runs the same mix over keys drawn uniformly from the whole
+	key space: 90% find, 5% insert, 5% erase. The map is prefilled with half
+	the key space so finds hit about half the time.
+
+	Build and run from the repository root:
+		g++ -O2 -std=c++17 -pthread -I. bench/sharded-throughput.cpp -o sharded-throughput
+		./sharded-throughput [operations per thread] [shards]
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl-sharded.h"
+#include <chrono>  // std::chrono::steady_clock
+#include <cstdio>  // std::printf
+#include <cstdlib> // std::strtoul
+#include <random>  // std::mt19937_64
+#include <thread>  // std::thread
+#include <vector>  // std::vector
+
+namespace {
+	const unsigned long keySpace = 1UL << 20;
+
+	//-----------------------------------------------------------------------------
+	// Run the mix on `threads` threads; returns millions of operations a second
+	//-----------------------------------------------------------------------------
+	double run(CS280::ShardedAVLmap<unsigned long, unsigned long>& map, unsigned threads, unsigned long ops) {
+		std::vector<std::thread> workers;
+		auto start = std::chrono::steady_clock::now();
+		for (unsigned t = 0; t < threads; ++t) {
+			workers.emplace_back([&map, ops, t] {
+				std::mt19937_64 rng(t + 1);
+				unsigned long value = 0;
+				for (unsigned long i = 0; i < ops; ++i) {
+					unsigned long r   = rng();
+					unsigned long key = (r >> 8) % keySpace;
+					switch (r % 20) {
+					case 0:  map.insert(key, i); break;
+					case 1:  map.erase(key);     break;
+					default: map.find(key, value);
+					}
+				}
+			});
+		}
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return threads * ops / seconds / 1e6;
+	}
+
+	//-----------------------------------------------------------------------------
+	// Fresh, prefilled map for one measurement
+	//-----------------------------------------------------------------------------
+	double measure(std::size_t shards, CS280::ShardPartition partition, unsigned threads, unsigned long ops) {
+		CS280::ShardedAVLmap<unsigned long, unsigned long> map(shards, partition);
+		for (unsigned long key = 0; key < keySpace; key += 2) {
+			map.insert(key, key);
+		}
+		map.rebalance();
+		return run(map, threads, ops);
+	}
+}
+
+int main(int argc, char** argv) {
+	unsigned long ops   = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 200000;
+	std::size_t  shards = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 32;
+
+	std::printf("%u hardware threads, %lu operations per thread, %zu shards (Mops/s)\n", std::thread::hardware_concurrency(), ops, shards);
+	std::printf("%8s %12s %12s %12s\n", "threads", "one lock", "range", "hash");
+	for (unsigned threads = 1; threads <= 32; threads *= 2) {
+		double single = measure(1, CS280::ShardPartition::Range, threads, ops);
+		double range  = measure(shards, CS280::ShardPartition::Range, threads, ops);
+		double hash   = measure(shards, CS280::ShardPartition::Hash, threads, ops);
+		std::printf("%8u %12.2f %12.2f %12.2f\n", threads, single, range, hash);
+	}
+	return 0;
+}
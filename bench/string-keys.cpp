@@ -0,0 +1,119 @@
+/*!*****************************************************************************
+*\file     string-keys.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	StringAVLmap against AVLmap<std::string, V> on keys with long shared
+	prefixes: memory per key (memory_usage(), allocator slack included) and
+	find time over every key in random order.
+
+	Two key sets: URLs (~70 bytes) and file paths (~115 bytes). They are
+	measured at a cache resident size and one far larger than the cache,
+	where StringAVLmap pays an extra miss per level for key bytes that no
+	longer sit next to the node (see avl-string.h).
+
+	Build and run from the repository root:
+		g++ -O2 -std=c++17 -I. bench/string-keys.cpp -o string-keys
+		./string-keys [small keys] [large keys]
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl-string.h"
+#include <algorithm> // std::shuffle
+#include <chrono>    // std::chrono::steady_clock
+#include <cstdio>    // std::printf, std::snprintf
+#include <cstdlib>   // std::strtoul
+#include <random>    // std::mt19937
+#include <string>    // std::string
+#include <vector>    // std::vector
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+
+	//-----------------------------------------------------------------------------
+	// Key sets
+	//-----------------------------------------------------------------------------
+	std::vector<std::string> urlKeys(std::size_t count) {
+		std::vector<std::string> keys;
+		char buffer[160];
+		for (std::size_t i = 0; i < count; ++i) {
+			std::snprintf(buffer, sizeof(buffer), "https://www.example.com/catalog/category-%03zu/item-%07zu?ref=home", i % 97, i);
+			keys.push_back(buffer);
+		}
+		return keys;
+	}
+
+	std::vector<std::string> pathKeys(std::size_t count) {
+		std::vector<std::string> keys;
+		char buffer[200];
+		for (std::size_t i = 0; i < count; ++i) {
+			std::snprintf(buffer, sizeof(buffer), "/srv/data/projects/warehouse/ingest/2024/region-%02zu/partition-%04zu/segments/segment-%08zu.parquet", i % 13, i % 1021, i);
+			keys.push_back(buffer);
+		}
+		return keys;
+	}
+
+	//-----------------------------------------------------------------------------
+	// Nanoseconds per find over the keys in random order
+	//-----------------------------------------------------------------------------
+	template<typename FIND>
+	double findTime(std::vector<std::string> const& keys, FIND find) {
+		std::vector<std::string const*> order;
+		for (std::string const& key : keys) order.push_back(&key);
+		std::shuffle(order.begin(), order.end(), std::mt19937(5));
+
+		long hits = 0;
+		clock_type::time_point start = clock_type::now();
+		for (std::string const* key : order) {
+			hits += find(*key);
+		}
+		double ns = std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / order.size();
+		return (hits == static_cast<long>(keys.size())) ? ns : -1.0; // -1: a key was missing
+	}
+
+	//-----------------------------------------------------------------------------
+	// One key set at one size, both maps
+	//-----------------------------------------------------------------------------
+	void compare(char const* name, std::vector<std::string> const& keys) {
+		double generic[2];
+		{
+			CS280::AVLmap<std::string, int> map;
+			for (std::size_t i = 0; i < keys.size(); ++i) {
+				map.insert(keys[i], static_cast<int>(i));
+			}
+			CS280::AVLmapMemory memory = map.memory_usage([](std::string const& key, int const&) {
+				std::size_t heap = (key.capacity() > 15) ? key.capacity() + 1 : 0; // past the small string buffer
+				return (heap) ? heap + CS280::AVLmapMemory::allocationSlack(heap) : 0;
+			});
+			generic[0] = static_cast<double>(memory.total()) / map.size();
+			generic[1] = findTime(keys, [&map](std::string const& key) { return map.find(key) != map.end(); });
+		}
+
+		double compact[2];
+		{
+			CS280::StringAVLmap<int> map;
+			for (std::size_t i = 0; i < keys.size(); ++i) {
+				map.insert(keys[i], static_cast<int>(i));
+			}
+			compact[0] = static_cast<double>(map.memory_usage().total()) / map.size();
+			compact[1] = findTime(keys, [&map](std::string const& key) { return map.find(key) != nullptr; });
+		}
+
+		std::printf("%-6s %9zu %14.0f %14.0f %14.0f %14.0f\n", name, keys.size(), generic[0], compact[0], generic[1], compact[1]);
+	}
+}
+
+int main(int argc, char** argv) {
+	std::size_t small = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 20000;
+	std::size_t large = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 500000;
+
+	std::printf("%-6s %9s %14s %14s %14s %14s\n", "keys", "count", "B/key string", "B/key compact", "ns string", "ns compact");
+	std::size_t const counts[] = { small, large };
+	for (std::size_t count : counts) {
+		compare("url", urlKeys(count));
+		compare("path", pathKeys(count));
+	}
+	return 0;
+}
@@ -0,0 +1,89 @@
+/*!*****************************************************************************
+*\file     value-layout.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	Lookup throughput of InlineValues against SeparateValues across value
+	sizes: the map is filled with random long keys, then random keys (half
+	of them present) are looked up with find(). Larger values spread inline
+	nodes over more cache lines; separate values keep the nodes the search
+	walks small.
+
+	Build and run from the repository root:
+		g++ -O2 -std=c++17 -I. bench/value-layout.cpp -o value-layout
+		./value-layout [keys] [finds]
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl.h"
+#include <chrono>  // std::chrono::steady_clock
+#include <cstdio>  // std::printf
+#include <cstdlib> // std::strtoul
+#include <random>  // std::mt19937_64
+#include <vector>  // std::vector
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+
+	//-----------------------------------------------------------------------------
+	// A value of BYTES bytes
+	//-----------------------------------------------------------------------------
+	template<std::size_t BYTES>
+	struct Payload {
+		char bytes[BYTES] = {};
+	};
+
+	//-----------------------------------------------------------------------------
+	// Millions of finds a second for one layout and value size
+	//-----------------------------------------------------------------------------
+	template<typename LAYOUT, std::size_t BYTES>
+	double findRate(std::vector<long> const& keys, std::vector<long> const& queries) {
+		CS280::AVLmap<long, Payload<BYTES>, LAYOUT> map;
+		for (long key : keys) {
+			map.insert(key, Payload<BYTES>());
+		}
+
+		long hits = 0;
+		clock_type::time_point start = clock_type::now();
+		for (long key : queries) {
+			hits += (map.find(key) != map.end());
+		}
+		double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+		return (hits > 0) ? queries.size() / seconds / 1e6 : -1.0; // hits keep the finds from being optimised away
+	}
+
+	template<std::size_t BYTES>
+	void row(std::vector<long> const& keys, std::vector<long> const& queries) {
+		double inlined  = findRate<CS280::InlineValues, BYTES>(keys, queries);
+		double separate = findRate<CS280::SeparateValues, BYTES>(keys, queries);
+		std::printf("%8zu %14.2f %14.2f %10s\n", BYTES, inlined, separate,
+			CS280::AutoValues<>::separate<Payload<BYTES>>::value ? "separate" : "inline");
+	}
+}
+
+int main(int argc, char** argv) {
+	std::size_t count = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 500000;
+	std::size_t finds = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 2000000;
+
+	std::mt19937_64 rng(11);
+	std::vector<long> keys(count);
+	for (long& key : keys) {
+		key = static_cast<long>(rng() % (2 * count));
+	}
+	std::vector<long> queries(finds);
+	for (long& key : queries) {
+		key = static_cast<long>(rng() % (2 * count));
+	}
+
+	std::printf("%zu keys, %zu random finds (M finds/s)\n", count, finds);
+	std::printf("%8s %14s %14s %10s\n", "value B", "inline", "separate", "auto picks");
+	row<8>(keys, queries);
+	row<32>(keys, queries);
+	row<64>(keys, queries);
+	row<128>(keys, queries);
+	row<200>(keys, queries);
+	row<512>(keys, queries);
+	return 0;
+}
@@ -0,0 +1,53 @@
+/*!*****************************************************************************
+*\file     cache-ttl.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	AVLcache with a ttl shorter than a single operation: every entry has
+	expired by the time the eviction sweep runs, but the entry just written
+	must survive until the caller is done with it.
+
+	Build and run from the repository root (a failed check exits non-zero):
+		g++ -O1 -g -std=c++17 -fsanitize=address,undefined -I. tests/cache-ttl.cpp -o cache-ttl
+		./cache-ttl
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl-cache.h"
+#include <cstdio> // std::printf
+
+#define CHECK(cond)                                                       \
+	do {                                                                  \
+		if (!(cond)) {                                                    \
+			std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			return 1;                                                     \
+		}                                                                 \
+	} while (0)
+
+int main() {
+	CS280::AVLcache<int, int> cache(10, 0, std::chrono::nanoseconds(1));
+
+	// operator[] on a miss returns the fresh entry; writing through it is safe
+	int& value = cache[5];
+	value = 42;
+	CHECK(cache.size() == 1);
+
+	// The next write sweeps the now expired entry away but keeps its own
+	for (int key = 0; key < 100; ++key) {
+		cache.insert(key, key);
+		CHECK(cache.size() == 1);
+	}
+	cache[200] = 7;
+	CHECK(cache.size() == 1);
+
+	// Reads see every entry as expired, and evictExpired() drops the rest
+	CHECK(cache.find(200) == nullptr);
+	cache.insert(300, 1);
+	CHECK(cache.evictExpired() == 1);
+	CHECK(cache.size() == 0);
+
+	std::printf("cache-ttl: ok\n");
+	return 0;
+}
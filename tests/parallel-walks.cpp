@@ -0,0 +1,115 @@
+/*!*****************************************************************************
+*\file     parallel-walks.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	parallel_for_each, parallel_transform_reduce and parallel_collect_if
+	against std::map, for every BALANCE policy, map sizes 0 to 100k and 1,
+	2, 3 and 8 threads:
+	1) for_each updates every value and leaves valid aggregates behind
+	2) transform_reduce keeps key order (a non-commutative string concat)
+	3) collect_if returns the matches in key order
+	4) an exception thrown by a callback reaches the caller
+
+	Build and run from the repository root (a failed check exits non-zero):
+		g++ -O1 -g -std=c++17 -pthread -fsanitize=address,undefined -I. tests/parallel-walks.cpp -o parallel-walks
+		./parallel-walks
+	(-fsanitize=thread instead checks the workers for data races.)
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl-parallel.h"
+#include <climits> // INT_MIN, INT_MAX
+#include <cstdio>  // std::printf
+#include <map>     // std::map
+#include <random>  // std::mt19937
+#include <string>  // std::string, std::to_string
+
+#define CHECK(cond)                                                       \
+	do {                                                                  \
+		if (!(cond)) {                                                    \
+			std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			return 1;                                                     \
+		}                                                                 \
+	} while (0)
+
+namespace {
+	//-----------------------------------------------------------------------------
+	// All walks on one policy; returns non-zero on the first failed check
+	//-----------------------------------------------------------------------------
+	template<typename BALANCE>
+	int run() {
+		typedef CS280::AVLmap<int, long, CS280::AutoValues<>, CS280::SumAggregate<long>, BALANCE> map_type;
+
+		std::mt19937 rng(7);
+		int const sizes[] = { 0, 1, 2, 5, 100, 5000, 100000 };
+		unsigned const threadCounts[] = { 1, 2, 3, 8 };
+		for (int n : sizes) {
+			for (unsigned threads : threadCounts) {
+				map_type map;
+				std::map<int, long> reference;
+				for (int i = 0; i < n; ++i) {
+					int key = static_cast<int>(rng() % INT_MAX);
+					map.insert(key, i);
+					reference[key] = i;
+				}
+
+				// 1) for_each
+				CS280::parallel_for_each(map, [](int const&, long& value) { value = value * 2 + 1; }, threads);
+				long sum = 0;
+				for (std::pair<int const, long>& entry : reference) {
+					entry.second = entry.second * 2 + 1;
+					sum += entry.second;
+				}
+				CHECK(map.validate());
+				CHECK(map.reduce(INT_MIN, INT_MAX) == sum);
+
+				// 2) transform_reduce, commutative and not
+				CHECK(CS280::parallel_transform_reduce(map, 0L,
+					[](long a, long b) { return a + b; },
+					[](int const&, long const& value) { return value; }, threads) == sum);
+
+				std::string digits;
+				for (std::pair<int const, long> const& entry : reference) {
+					digits += std::to_string(entry.first % 10);
+				}
+				CHECK(CS280::parallel_transform_reduce(map, std::string(),
+					[](std::string a, std::string const& b) { return a + b; },
+					[](int const& key, long const&) { return std::to_string(key % 10); }, threads) == digits);
+
+				// 3) collect_if
+				std::vector<std::pair<int, long>> expected;
+				for (std::pair<int const, long> const& entry : reference) {
+					if (entry.first % 3 == 0) expected.push_back(entry);
+				}
+				CHECK(CS280::parallel_collect_if(map, [](int const& key, long const&) { return key % 3 == 0; }, threads) == expected);
+
+				// 4) exceptions
+				bool sevens = false;
+				for (std::pair<int const, long> const& entry : reference) {
+					sevens = sevens || entry.first % 7 == 0;
+				}
+				bool thrown = false;
+				try {
+					CS280::parallel_for_each(map, [](int const& key, long&) { if (key % 7 == 0) throw 42; }, threads);
+				}
+				catch (int value) {
+					thrown = (value == 42);
+				}
+				CHECK(thrown == sevens);
+				CHECK(map.validate());
+			}
+		}
+		return 0;
+	}
+}
+
+int main() {
+	if (run<CS280::StrictAVL>() || run<CS280::RelaxedAVL>() || run<CS280::RedBlack>()) {
+		return 1;
+	}
+	std::printf("parallel-walks: ok\n");
+	return 0;
+}
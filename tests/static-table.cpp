@@ -0,0 +1,78 @@
+/*!*****************************************************************************
+*\file     static-table.cpp
+*\author   Jalin A. Brown
+*\brief Description:
+	StaticAVLmap built by the compiler and at run time:
+	1) a constexpr table whose ascending keys force every rotation case is
+	   a valid, balanced AVL tree and answers lookups (static_assert)
+	2) makeStaticAVLmap sizes a constexpr table to its entries
+	3) the same inserts at run time give the same tree
+	4) more keys than CAPACITY throw std::length_error at run time and do
+	   not compile in a constexpr table (build with -DOVERFULL_TABLE to see
+	   the error)
+
+	Build and run from the repository root (a failed check exits non-zero):
+		g++ -O1 -g -std=c++17 -fsanitize=address,undefined -I. tests/static-table.cpp -o static-table
+		./static-table
+******************************************************************************/
+
+//-----------------------------------------------------------------------------
+// Includes:
+//-----------------------------------------------------------------------------
+
+#include "avl-static.h"
+#include <cstdio>      // std::printf
+#include <stdexcept>   // std::length_error
+#include <string_view> // std::string_view
+
+#define CHECK(cond)                                                       \
+	do {                                                                  \
+		if (!(cond)) {                                                    \
+			std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			return 1;                                                     \
+		}                                                                 \
+	} while (0)
+
+namespace {
+	//-----------------------------------------------------------------------------
+	// Compile time checks
+	//-----------------------------------------------------------------------------
+	constexpr CS280::StaticAVLmap<int, int, 7> rotations{ { { 1, 10 }, { 2, 20 }, { 3, 30 }, { 4, 40 }, { 5, 50 }, { 7, 70 }, { 6, 60 } } };
+	static_assert(rotations.validate(), "StaticAVLmap: constexpr table is not a valid AVL tree");
+	static_assert(rotations.size() == 7 && rotations.getHeight() == 2, "StaticAVLmap: constexpr table is not balanced");
+	static_assert(*rotations.find(6) == 60 && !rotations.contains(8), "StaticAVLmap: constexpr lookup failed");
+
+	constexpr std::pair<int, int> entries[] = { { 3, 3 }, { 1, 1 }, { 2, 2 } };
+	constexpr CS280::StaticAVLmap<int, int, 3> sized = CS280::makeStaticAVLmap(entries);
+	static_assert(sized.validate() && sized.getHeight() == 1, "StaticAVLmap: makeStaticAVLmap is not constexpr");
+
+	constexpr CS280::StaticAVLmap<std::string_view, int, 3> opcodes{ { { "add", 1 }, { "sub", 2 }, { "mul", 3 } } };
+	static_assert(*opcodes.find("sub") == 2 && !opcodes.contains("div"), "StaticAVLmap: string_view lookup failed");
+
+#ifdef OVERFULL_TABLE
+	constexpr CS280::StaticAVLmap<std::string_view, int, 2> overfull{ { { "add", 1 }, { "sub", 2 }, { "mul", 3 } } };
+#endif
+}
+
+int main() {
+	// 3) run time build matches the compile time one
+	CS280::StaticAVLmap<int, int, 7> table{ { { 1, 10 }, { 2, 20 }, { 3, 30 }, { 4, 40 }, { 5, 50 }, { 7, 70 }, { 6, 60 } } };
+	CHECK(table.validate());
+	CHECK(table.size() == rotations.size() && table.getHeight() == rotations.getHeight());
+	for (int key = 0; key <= 8; ++key) {
+		CHECK(table.contains(key) == rotations.contains(key));
+	}
+
+	// 4) overfull at run time
+	bool thrown = false;
+	try {
+		CS280::StaticAVLmap<int, int, 1> small{ { { 1, 1 }, { 2, 2 } } };
+	}
+	catch (std::length_error const&) {
+		thrown = true;
+	}
+	CHECK(thrown);
+
+	std::printf("static-table: ok\n");
+	return 0;
+}